@@ -0,0 +1,534 @@
+/*
+ * Copyright 2010-2016 OpenXcom Developers.
+ *
+ * This file is part of OpenXcom.
+ *
+ * OpenXcom is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenXcom is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <yaml-cpp/yaml.h>
+#include "../src/Engine/Logger.h"
+#include "../src/Engine/CrossPlatform.h"
+#include "../src/Engine/Exception.h"
+#include "../src/Engine/Game.h"
+#include "../src/Engine/Options.h"
+#include "../src/Engine/RNG.h"
+#include "../src/Battlescape/AIModule.h"
+#include "../src/Battlescape/BattlescapeGenerator.h"
+#include "../src/Battlescape/BattlescapeState.h"
+#include "../src/Battlescape/Pathfinding.h"
+#include "../src/Battlescape/TileEngine.h"
+#include "../src/Mod/AlienDeployment.h"
+#include "../src/Mod/Armor.h"
+#include "../src/Mod/Mod.h"
+#include "../src/Mod/RuleCraft.h"
+#include "../src/Mod/RuleGlobe.h"
+#include "../src/Mod/RuleItem.h"
+#include "../src/Savegame/Base.h"
+#include "../src/Savegame/BattleUnit.h"
+#include "../src/Savegame/Craft.h"
+#include "../src/Savegame/ItemContainer.h"
+#include "../src/Savegame/MissionSite.h"
+#include "../src/Savegame/SavedBattleGame.h"
+#include "../src/Savegame/SavedGame.h"
+#include "../src/Savegame/Soldier.h"
+#include "../src/Savegame/Tile.h"
+#include "../src/Savegame/Ufo.h"
+
+/**
+ * Headless battlescape benchmark.
+ *
+ * Loads a saved battle (or generates one from a fixed seed) under SDL's
+ * dummy video driver, then times the hot TileEngine, Pathfinding and
+ * AIModule entry points and reports per-call latency percentiles.
+ * Results can be stored as a baseline file and later runs are compared
+ * against it, so regressions show up as a percentage delta.
+ *
+ * Usage:
+ *   openxcom_bench [-save <file>] [-seed <n>] [-mission <deployment>]
+ *                  [-terrain <terrain>] [-race <race>] [-iterations <n>]
+ *                  [-baseline <file>] [-writeBaseline]
+ *                  [-data <folder>] [-user <folder>] [-cfg <folder>]
+ */
+
+using namespace OpenXcom;
+
+namespace
+{
+
+/**
+ * Latency samples for a single benchmarked function.
+ */
+struct Samples
+{
+	std::string name;
+	std::vector<Uint64> times;
+
+	/// Gets the given percentile of the samples, in microseconds.
+	double percentile(double p) const
+	{
+		if (times.empty())
+			return 0.0;
+		std::vector<Uint64> sorted = times;
+		std::sort(sorted.begin(), sorted.end());
+		size_t i = (size_t)(p / 100.0 * (sorted.size() - 1) + 0.5);
+		return (double)sorted[i];
+	}
+
+	/// Gets the mean of the samples, in microseconds.
+	double mean() const
+	{
+		if (times.empty())
+			return 0.0;
+		double total = 0.0;
+		for (std::vector<Uint64>::const_iterator i = times.begin(); i != times.end(); ++i)
+			total += *i;
+		return total / times.size();
+	}
+};
+
+/**
+ * Command line settings of the benchmark.
+ */
+struct Settings
+{
+	std::string save, mission, terrain, race, baseline;
+	Uint64 seed;
+	int iterations;
+	bool writeBaseline;
+	Settings() : mission("STR_TERROR_MISSION"), seed(1), iterations(50), writeBaseline(false) {}
+};
+
+const double PERCENTILES[] = { 50.0, 90.0, 99.0 };
+const int NUM_PERCENTILES = sizeof(PERCENTILES) / sizeof(PERCENTILES[0]);
+
+/**
+ * Splits the command line into benchmark settings and the
+ * arguments that are passed on to the regular Options.
+ * @param argc Number of arguments.
+ * @param argv Array of arguments.
+ * @param settings Benchmark settings to fill.
+ * @param passthrough Arguments for Options::init.
+ */
+void parseArgs(int argc, char *argv[], Settings &settings, std::vector<char*> &passthrough)
+{
+	passthrough.push_back(argv[0]);
+	for (int i = 1; i < argc; ++i)
+	{
+		std::string arg = argv[i];
+		bool hasValue = i + 1 < argc;
+		std::stringstream value;
+		if (arg == "-writeBaseline")
+			settings.writeBaseline = true;
+		else if (arg == "-save" && hasValue)
+			settings.save = argv[++i];
+		else if (arg == "-seed" && hasValue)
+		{
+			value << argv[++i];
+			value >> settings.seed;
+		}
+		else if (arg == "-mission" && hasValue)
+			settings.mission = argv[++i];
+		else if (arg == "-terrain" && hasValue)
+			settings.terrain = argv[++i];
+		else if (arg == "-race" && hasValue)
+			settings.race = argv[++i];
+		else if (arg == "-iterations" && hasValue)
+		{
+			value << argv[++i];
+			value >> settings.iterations;
+			settings.iterations = std::max(1, settings.iterations);
+		}
+		else if (arg == "-baseline" && hasValue)
+			settings.baseline = argv[++i];
+		else
+			passthrough.push_back(argv[i]);
+	}
+}
+
+/**
+ * Generates a new battle the same way the New Battle screen does,
+ * using whatever the current RNG seed dictates.
+ * @param game Pointer to the core game.
+ * @param settings Benchmark settings.
+ */
+void generateBattle(Game *game, const Settings &settings)
+{
+	Mod *mod = game->getMod();
+	AlienDeployment *deployment = mod->getDeployment(settings.mission, true);
+
+	SavedGame *save = new SavedGame();
+	Base *base = new Base(mod);
+	base->load(mod->getStartingBase(), save, true, true);
+	save->getBases()->push_back(base);
+	for (std::vector<Soldier*>::iterator i = base->getSoldiers()->begin(); i != base->getSoldiers()->end(); ++i)
+		delete *i;
+	base->getSoldiers()->clear();
+	for (std::vector<Craft*>::iterator i = base->getCrafts()->begin(); i != base->getCrafts()->end(); ++i)
+		delete *i;
+	base->getCrafts()->clear();
+	base->getStorageItems()->getContents()->clear();
+
+	Craft *craft = 0;
+	const std::vector<std::string> &crafts = mod->getCraftsList();
+	for (std::vector<std::string>::const_iterator i = crafts.begin(); i != crafts.end() && !craft; ++i)
+	{
+		RuleCraft *rule = mod->getCraft(*i);
+		if (rule->getSoldiers() > 0)
+			craft = new Craft(rule, base, 1);
+	}
+	if (!craft)
+		throw Exception("No craft can carry soldiers");
+	base->getCrafts()->push_back(craft);
+
+	for (int i = 0; i < craft->getRules()->getSoldiers(); ++i)
+	{
+		Soldier *soldier = mod->genSoldier(save, mod->getSoldiersList().front());
+		base->getSoldiers()->push_back(soldier);
+		soldier->setCraft(craft);
+	}
+	const std::vector<std::string> &items = mod->getItemsList();
+	for (std::vector<std::string>::const_iterator i = items.begin(); i != items.end(); ++i)
+	{
+		RuleItem *rule = mod->getItem(*i);
+		if (rule->getBattleType() != BT_CORPSE && rule->getBattleType() != BT_NONE && rule->isRecoverable() && !rule->isFixed() && rule->getBigSprite() > -1)
+			craft->getItems()->addItem(*i, 1);
+	}
+	const std::vector<std::string> &research = mod->getResearchList();
+	for (std::vector<std::string>::const_iterator i = research.begin(); i != research.end(); ++i)
+		save->addFinishedResearch(mod->getResearch(*i));
+	game->setSavedGame(save);
+
+	std::string race = settings.race;
+	if (race.empty())
+		race = mod->getAlienRacesList().front();
+	std::string terrain = settings.terrain;
+	if (terrain.empty())
+	{
+		std::vector<std::string> terrains = deployment->getTerrains();
+		if (terrains.empty())
+			terrains = mod->getGlobe()->getTerrains("");
+		if (terrains.empty())
+			throw Exception("No terrain available for " + settings.mission);
+		terrain = terrains.front();
+	}
+
+	SavedBattleGame *bgame = new SavedBattleGame();
+	save->setBattleGame(bgame);
+	bgame->setMissionType(settings.mission);
+	BattlescapeGenerator bgen = BattlescapeGenerator(game);
+	bgen.setTerrain(mod->getTerrain(terrain, true));
+	if (deployment->isAlienBase())
+	{
+		throw Exception("Alien base deployments are not supported, use -save instead");
+	}
+	else if (mod->getUfo(settings.mission))
+	{
+		Ufo *u = new Ufo(mod->getUfo(settings.mission));
+		u->setId(1);
+		u->setStatus(Ufo::CRASHED);
+		craft->setDestination(u);
+		bgen.setUfo(u);
+		bgame->setMissionType("STR_UFO_CRASH_RECOVERY");
+		save->getUfos()->push_back(u);
+	}
+	else
+	{
+		MissionSite *m = new MissionSite(mod->getAlienMission(mod->getAlienMissionList().front()), deployment);
+		m->setId(1);
+		m->setAlienRace(race);
+		craft->setDestination(m);
+		bgen.setMissionSite(m);
+		save->getMissionSites()->push_back(m);
+	}
+	craft->setSpeed(0);
+	bgen.setCraft(craft);
+	bgen.setWorldShade(0);
+	bgen.setAlienRace(race);
+	bgen.setAlienItemlevel(0);
+	bgen.run();
+}
+
+/**
+ * Picks a random tile position on the map.
+ * @param battle Pointer to the battle.
+ * @return Random position.
+ */
+Position randomPosition(SavedBattleGame *battle)
+{
+	return Position(RNG::generate(0, battle->getMapSizeX() - 1), RNG::generate(0, battle->getMapSizeY() - 1), RNG::generate(0, battle->getMapSizeZ() - 1));
+}
+
+/**
+ * Gets all units on the battlefield that are still standing.
+ * @param battle Pointer to the battle.
+ * @param hostileOnly Only consider alien units.
+ * @return List of units.
+ */
+std::vector<BattleUnit*> activeUnits(SavedBattleGame *battle, bool hostileOnly)
+{
+	std::vector<BattleUnit*> units;
+	for (std::vector<BattleUnit*>::iterator i = battle->getUnits()->begin(); i != battle->getUnits()->end(); ++i)
+	{
+		if (!(*i)->isOut() && (!hostileOnly || (*i)->getFaction() == FACTION_HOSTILE))
+			units.push_back(*i);
+	}
+	return units;
+}
+
+/**
+ * Times all the benchmarked functions.
+ * @param battle Pointer to the battle.
+ * @param settings Benchmark settings.
+ * @return Samples per function.
+ */
+std::vector<Samples> runBenchmarks(SavedBattleGame *battle, const Settings &settings)
+{
+	TileEngine *te = battle->getTileEngine();
+	Pathfinding *pf = battle->getPathfinding();
+	std::vector<BattleUnit*> units = activeUnits(battle, false);
+	std::vector<BattleUnit*> aliens = activeUnits(battle, true);
+	if (units.empty())
+		throw Exception("Battle has no active units");
+
+	std::vector<Samples> results;
+	Samples fov, refov, path, reach, rereach, think, turn, explode;
+	fov.name = "TileEngine::calculateFOV";
+	refov.name = "TileEngine::recalculateFOV";
+	path.name = "Pathfinding::calculate";
+	reach.name = "Pathfinding::findReachable";
+	rereach.name = "Pathfinding::findReachable (cached)";
+	think.name = "AIModule::think";
+	turn.name = "AIModule::think (turn)";
+	explode.name = "TileEngine::explode";
+
+	for (int n = 0; n < settings.iterations; ++n)
+	{
+		RNG::setSeed(settings.seed + n);
+		for (std::vector<BattleUnit*>::iterator i = units.begin(); i != units.end(); ++i)
+		{
+			Uint64 start = CrossPlatform::getMicroseconds();
+			te->calculateFOV(*i);
+			fov.times.push_back(CrossPlatform::getMicroseconds() - start);
+		}
+
+		Uint64 start = CrossPlatform::getMicroseconds();
+		te->recalculateFOV();
+		refov.times.push_back(CrossPlatform::getMicroseconds() - start);
+
+		for (std::vector<BattleUnit*>::iterator i = units.begin(); i != units.end(); ++i)
+		{
+			Position target = randomPosition(battle);
+			start = CrossPlatform::getMicroseconds();
+			pf->calculate(*i, target);
+			path.times.push_back(CrossPlatform::getMicroseconds() - start);
+			pf->abortPath();
+
+			// time a full search first, then the same query answered from the cache
+			battle->unitsChanged();
+			start = CrossPlatform::getMicroseconds();
+			pf->findReachable(*i, (*i)->getBaseStats()->tu);
+			reach.times.push_back(CrossPlatform::getMicroseconds() - start);
+
+			start = CrossPlatform::getMicroseconds();
+			pf->findReachable(*i, (*i)->getBaseStats()->tu);
+			rereach.times.push_back(CrossPlatform::getMicroseconds() - start);
+		}
+
+		Uint64 turnTime = 0;
+		for (std::vector<BattleUnit*>::iterator i = aliens.begin(); i != aliens.end(); ++i)
+		{
+			if (!(*i)->getAIModule())
+				(*i)->setAIModule(new AIModule(battle, *i, 0));
+			BattleAction action;
+			action.actor = *i;
+			action.number = 1;
+			start = CrossPlatform::getMicroseconds();
+			(*i)->think(&action);
+			Uint64 elapsed = CrossPlatform::getMicroseconds() - start;
+			think.times.push_back(elapsed);
+			turnTime += elapsed;
+			pf->abortPath();
+		}
+		if (!aliens.empty())
+			turn.times.push_back(turnTime);
+	}
+
+	// smoke goes through the same ray casting as high explosives
+	// but leaves the terrain intact for the next run
+	for (int n = 0; n < settings.iterations; ++n)
+	{
+		RNG::setSeed(settings.seed + n);
+		Position center = randomPosition(battle) * Position(16, 16, 24) + Position(8, 8, 12);
+		Uint64 start = CrossPlatform::getMicroseconds();
+		te->explode(center, 120, DT_SMOKE, 10);
+		explode.times.push_back(CrossPlatform::getMicroseconds() - start);
+	}
+
+	results.push_back(fov);
+	results.push_back(refov);
+	results.push_back(path);
+	results.push_back(reach);
+	results.push_back(rereach);
+	results.push_back(think);
+	results.push_back(turn);
+	results.push_back(explode);
+	return results;
+}
+
+/**
+ * Prints the results, comparing them against a baseline if one exists.
+ * @param results Samples per function.
+ * @param baseline Baseline YAML document, may be null.
+ */
+void report(const std::vector<Samples> &results, const YAML::Node &baseline)
+{
+	std::cout << std::left << std::setw(32) << "function" << std::right << std::setw(8) << "calls"
+		<< std::setw(12) << "mean" << std::setw(12) << "p50" << std::setw(12) << "p90" << std::setw(12) << "p99";
+	if (baseline)
+		std::cout << std::setw(12) << "p50 delta" << std::setw(12) << "p90 delta";
+	std::cout << std::endl;
+	std::cout << std::fixed << std::setprecision(1);
+	for (std::vector<Samples>::const_iterator i = results.begin(); i != results.end(); ++i)
+	{
+		std::cout << std::left << std::setw(32) << i->name << std::right << std::setw(8) << i->times.size() << std::setw(12) << i->mean();
+		for (int p = 0; p < NUM_PERCENTILES; ++p)
+			std::cout << std::setw(12) << i->percentile(PERCENTILES[p]);
+		if (baseline && baseline[i->name])
+		{
+			const YAML::Node &old = baseline[i->name];
+			for (int p = 0; p < 2; ++p)
+			{
+				std::ostringstream key;
+				key << "p" << (int)PERCENTILES[p];
+				double before = old[key.str()].as<double>(0.0);
+				std::ostringstream delta;
+				if (before > 0.0)
+					delta << std::showpos << std::fixed << std::setprecision(1) << (i->percentile(PERCENTILES[p]) - before) * 100.0 / before << "%";
+				else
+					delta << "-";
+				std::cout << std::setw(12) << delta.str();
+			}
+		}
+		std::cout << std::endl;
+	}
+	std::cout << "(times in microseconds)" << std::endl;
+}
+
+/**
+ * Saves the results as a new baseline file.
+ * @param results Samples per function.
+ * @param filename Baseline filename.
+ */
+void writeBaseline(const std::vector<Samples> &results, const std::string &filename)
+{
+	YAML::Emitter out;
+	YAML::Node node;
+	for (std::vector<Samples>::const_iterator i = results.begin(); i != results.end(); ++i)
+	{
+		node[i->name]["calls"] = i->times.size();
+		node[i->name]["mean"] = i->mean();
+		for (int p = 0; p < NUM_PERCENTILES; ++p)
+		{
+			std::ostringstream key;
+			key << "p" << (int)PERCENTILES[p];
+			node[i->name][key.str()] = i->percentile(PERCENTILES[p]);
+		}
+	}
+	out << node;
+	std::ofstream file(filename.c_str());
+	if (!file)
+		throw Exception("Failed to save " + filename);
+	file << out.c_str() << std::endl;
+}
+
+}
+
+int main(int argc, char *argv[])
+{
+	Settings settings;
+	std::vector<char*> passthrough;
+	parseArgs(argc, argv, settings, passthrough);
+
+	SDL_putenv((char*)"SDL_VIDEODRIVER=dummy");
+	SDL_putenv((char*)"SDL_AUDIODRIVER=dummy");
+	Logger::reportingLevel() = LOG_WARNING;
+	if (!Options::init((int)passthrough.size(), &passthrough[0]))
+		return EXIT_SUCCESS;
+
+	Game *game = 0;
+	try
+	{
+		game = new Game("OpenXcom Benchmark");
+		State::setGamePtr(game);
+		Options::updateMods();
+		game->loadMods();
+		game->defaultLanguage();
+
+		RNG::setSeed(settings.seed);
+		if (!settings.save.empty())
+		{
+			SavedGame *save = new SavedGame();
+			game->setSavedGame(save);
+			save->load(settings.save, game->getMod());
+			if (!save->getSavedBattle())
+				throw Exception(settings.save + " has no battle in progress");
+			save->getSavedBattle()->loadMapResources(game->getMod());
+		}
+		else
+		{
+			generateBattle(game, settings);
+		}
+
+		SavedBattleGame *battle = game->getSavedGame()->getSavedBattle();
+		BattlescapeState *bs = new BattlescapeState;
+		game->pushState(bs);
+		battle->setBattleState(bs);
+		battle->getTileEngine()->calculateSunShading();
+		battle->getTileEngine()->calculateTerrainLighting();
+		battle->getTileEngine()->calculateUnitLighting();
+
+		std::cout << "Map " << battle->getMapSizeX() << "x" << battle->getMapSizeY() << "x" << battle->getMapSizeZ()
+			<< ", " << activeUnits(battle, false).size() << " units, " << activeUnits(battle, true).size() << " hostile, "
+			<< settings.iterations << " iterations, seed " << settings.seed << std::endl;
+
+		std::vector<Samples> results = runBenchmarks(battle, settings);
+
+		YAML::Node baseline;
+		if (!settings.baseline.empty() && !settings.writeBaseline && CrossPlatform::fileExists(settings.baseline))
+			baseline = YAML::LoadFile(settings.baseline);
+		report(results, baseline);
+		if (!settings.baseline.empty() && settings.writeBaseline)
+		{
+			writeBaseline(results, settings.baseline);
+			std::cout << "Baseline saved to " << settings.baseline << std::endl;
+		}
+	}
+	catch (std::exception &e)
+	{
+		std::cerr << e.what() << std::endl;
+		delete game;
+		return EXIT_FAILURE;
+	}
+
+	delete game;
+	return EXIT_SUCCESS;
+}
@@ -142,7 +142,7 @@ void PlaceFacilityState::viewClick(Action *)
 		fac->setX(_view->getGridX());
 		fac->setY(_view->getGridY());
 		fac->setBuildTime(_rule->getBuildTime());
-		_base->getFacilities()->push_back(fac);
+		_base->addFacility(fac);
 		if (Options::allowBuildingQueue)
 		{
 			if (_view->isQueuedBuilding(_rule)) fac->setBuildTime(INT_MAX);
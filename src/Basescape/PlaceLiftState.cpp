@@ -88,7 +88,7 @@ void PlaceLiftState::viewClick(Action *)
 	BaseFacility *fac = new BaseFacility(_lift, _base);
 	fac->setX(_view->getGridX());
 	fac->setY(_view->getGridY());
-	_base->getFacilities()->push_back(fac);
+	_base->addFacility(fac);
 	_game->popState();
 	BasescapeState *bState = new BasescapeState(_base, _globe);
 	_game->getSavedGame()->setSelectedBase(_game->getSavedGame()->getBases()->size() - 1);
@@ -70,7 +70,7 @@ void PlaceStartFacilityState::viewClick(Action *)
 		BaseFacility *fac = new BaseFacility(_rule, _base);
 		fac->setX(_view->getGridX());
 		fac->setY(_view->getGridY());
-		_base->getFacilities()->push_back(fac);
+		_base->addFacility(fac);
 		_game->popState();
 		_select->facilityBuilt();
 	}
@@ -78,11 +78,7 @@ void SelectStartFacilityState::populateBuildList()
  */
 void SelectStartFacilityState::btnOkClick(Action *)
 {
-	for (std::vector<BaseFacility*>::iterator i = _base->getFacilities()->begin(); i != _base->getFacilities()->end(); ++i)
-	{
-		delete *i;
-	}
-	_base->getFacilities()->clear();
+	_base->clearFacilities();
 	_game->popState();
 	_game->popState();
 	_game->pushState(new PlaceLiftState(_base, _globe, true));
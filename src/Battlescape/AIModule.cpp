@@ -28,6 +28,7 @@
 #include "BattlescapeState.h"
 #include "../Savegame/Tile.h"
 #include "Pathfinding.h"
+#include "PlanningPool.h"
 #include "../Engine/RNG.h"
 #include "../Engine/Logger.h"
 #include "../Engine/Game.h"
@@ -586,13 +587,11 @@ void AIModule::setupAmbush()
 
 	if (selectClosestKnownEnemy())
 	{
-		Position target;
-		const int BASE_SYSTEMATIC_SUCCESS = 100;
-		const int COVER_BONUS = 25;
 		const int FAST_PASS_THRESHOLD = 80;
 		Position origin = _save->getTileEngine()->getSightOriginVoxel(_aggroTarget);
 
 		// we'll use node positions for this, as it gives map makers a good degree of control over how the units will use the environment.
+		_candidates.clear();
 		for (std::vector<Node*>::const_iterator i = _save->getNodes()->begin(); i != _save->getNodes()->end(); ++i)
 		{
 			if ((*i)->isDummy())
@@ -611,39 +610,34 @@ void AIModule::setupAmbush()
 				tile->setPreview(10);
 				tile->setMarkerColor(13);
 			}
-
-			// make sure we can't be seen here.
-			if (!_save->getTileEngine()->canTargetUnit(&origin, tile, &target, _aggroTarget, _unit) && !getSpottingUnits(pos))
+			_candidates.push_back(pos);
+		}
+
+		// score the candidates a batch at a time on the planning pool, then pick in order
+		_candidateOrigin = origin;
+		_candidateScores.assign(_candidates.size(), 0);
+		_candidateTUs.assign(_candidates.size(), 0);
+		_candidatePaths.assign(_candidates.size(), std::vector<int>());
+		PlanningPool *pool = _save->getPlanningPool();
+		PlanningPool::MemberJob<AIModule> job(this, &AIModule::scoreAmbushPoint);
+		int batch = pool->getThreadCount() * 2;
+		bool done = false;
+		for (int first = 0; first < (int)_candidates.size() && !done; first += batch)
+		{
+			int last = std::min(first + batch, (int)_candidates.size());
+			pool->run(&job, first, last);
+			for (int i = first; i < last; ++i)
 			{
-				_save->getPathfinding()->calculate(_unit, pos);
-				int ambushTUs = _save->getPathfinding()->getTotalTUCost();
-				// make sure we can move here
-				if (_save->getPathfinding()->getStartDirection() != -1)
+				if (_candidateScores[i] > bestScore)
 				{
-					int score = BASE_SYSTEMATIC_SUCCESS;
-					score -= ambushTUs;
-
-					// make sure our enemy can reach here too.
-					_save->getPathfinding()->calculate(_aggroTarget, pos);
-
-					if (_save->getPathfinding()->getStartDirection() != -1)
+					path = _candidatePaths[i];
+					bestScore = _candidateScores[i];
+					_ambushTUs = (_candidates[i] == _unit->getPosition()) ? 1 : _candidateTUs[i];
+					_ambushAction->target = _candidates[i];
+					if (bestScore > FAST_PASS_THRESHOLD)
 					{
-						// ideally we'd like to be behind some cover, like say a window or a low wall.
-						if (_save->getTileEngine()->faceWindow(pos) != -1)
-						{
-							score += COVER_BONUS;
-						}
-						if (score > bestScore)
-						{
-							path = _save->getPathfinding()->copyPath();
-							bestScore = score;
-							_ambushTUs = (pos == _unit->getPosition()) ? 1 : ambushTUs;
-							_ambushAction->target = pos;
-							if (bestScore > FAST_PASS_THRESHOLD)
-							{
-								break;
-							}
-						}
+						done = true;
+						break;
 					}
 				}
 			}
@@ -1436,11 +1430,10 @@ bool AIModule::findFirePoint()
 		return false;
 	std::vector<Position> randomTileSearch = _save->getTileSearch();
 	RNG::shuffle(randomTileSearch);
-	Position target;
-	const int BASE_SYSTEMATIC_SUCCESS = 100;
 	const int FAST_PASS_THRESHOLD = 125;
 	int bestScore = 0;
 	_attackAction->type = BA_RETHINK;
+	_candidates.clear();
 	for (std::vector<Position>::const_iterator i = randomTileSearch.begin(); i != randomTileSearch.end(); ++i)
 	{
 		Position pos = _unit->getPosition() + *i;
@@ -1448,33 +1441,30 @@ bool AIModule::findFirePoint()
 		if (tile == 0  ||
 			std::find(_reachableWithAttack.begin(), _reachableWithAttack.end(), _save->getTileIndex(pos))  == _reachableWithAttack.end())
 			continue;
-		int score = 0;
-		// i should really make a function for this
-		Position origin = (pos * Position(16,16,24)) +
-			// 4 because -2 is eyes and 2 below that is the rifle (or at least that's my understanding)
-			Position(8,8, _unit->getHeight() + _unit->getFloatHeight() - tile->getTerrainLevel() - 4);
+		_candidates.push_back(pos);
+	}
 
-		if (_save->getTileEngine()->canTargetUnit(&origin, _aggroTarget->getTile(), &target, _unit))
+	// score the candidates a batch at a time on the planning pool, then pick in order
+	_candidateScores.assign(_candidates.size(), 0);
+	PlanningPool *pool = _save->getPlanningPool();
+	PlanningPool::MemberJob<AIModule> job(this, &AIModule::scoreFirePoint);
+	int batch = pool->getThreadCount() * 2;
+	bool done = false;
+	for (int first = 0; first < (int)_candidates.size() && !done; first += batch)
+	{
+		int last = std::min(first + batch, (int)_candidates.size());
+		pool->run(&job, first, last);
+		for (int i = first; i < last; ++i)
 		{
-			_save->getPathfinding()->calculate(_unit, pos);
-			// can move here
-			if (_save->getPathfinding()->getStartDirection() != -1)
+			if (_candidateScores[i] > bestScore)
 			{
-				score = BASE_SYSTEMATIC_SUCCESS - getSpottingUnits(pos) * 10;
-				score += _unit->getTimeUnits() - _save->getPathfinding()->getTotalTUCost();
-				if (!_aggroTarget->checkViewSector(pos))
-				{
-					score += 10;
-				}
-				if (score > bestScore)
+				bestScore = _candidateScores[i];
+				_attackAction->target = _candidates[i];
+				_attackAction->finalFacing = _save->getTileEngine()->getDirectionTo(_candidates[i], _aggroTarget->getPosition());
+				if (bestScore > FAST_PASS_THRESHOLD)
 				{
-					bestScore = score;
-					_attackAction->target = pos;
-					_attackAction->finalFacing = _save->getTileEngine()->getDirectionTo(pos, _aggroTarget->getPosition());
-					if (score > FAST_PASS_THRESHOLD)
-					{
-						break;
-					}
+					done = true;
+					break;
 				}
 			}
 		}
@@ -1497,6 +1487,87 @@ bool AIModule::findFirePoint()
 	return false;
 }
 
+/**
+ * Scores a candidate position to attack our target from: we need to be able
+ * to target him from there and to get there. Runs on the planning pool,
+ * so it only reads the battle and stores the result in the candidate list.
+ * @param pathfinding The pathfinding of the thread running this.
+ * @param index Index of the candidate.
+ */
+void AIModule::scoreFirePoint(Pathfinding *pathfinding, int index)
+{
+	const int BASE_SYSTEMATIC_SUCCESS = 100;
+	Position pos = _candidates[index];
+	Tile *tile = _save->getTile(pos);
+	Position target;
+	int score = 0;
+	// i should really make a function for this
+	Position origin = (pos * Position(16,16,24)) +
+		// 4 because -2 is eyes and 2 below that is the rifle (or at least that's my understanding)
+		Position(8,8, _unit->getHeight() + _unit->getFloatHeight() - tile->getTerrainLevel() - 4);
+
+	if (_save->getTileEngine()->canTargetUnit(&origin, _aggroTarget->getTile(), &target, _unit))
+	{
+		pathfinding->calculate(_unit, pos);
+		// can move here
+		if (pathfinding->getStartDirection() != -1)
+		{
+			score = BASE_SYSTEMATIC_SUCCESS - getSpottingUnits(pos) * 10;
+			score += _unit->getTimeUnits() - pathfinding->getTotalTUCost();
+			if (!_aggroTarget->checkViewSector(pos))
+			{
+				score += 10;
+			}
+		}
+	}
+	_candidateScores[index] = score;
+}
+
+/**
+ * Scores a candidate position to ambush our target from: we must not be
+ * seen there, and both we and our target must be able to get there.
+ * Runs on the planning pool, so it only reads the battle and stores the
+ * result in the candidate list.
+ * @param pathfinding The pathfinding of the thread running this.
+ * @param index Index of the candidate.
+ */
+void AIModule::scoreAmbushPoint(Pathfinding *pathfinding, int index)
+{
+	const int BASE_SYSTEMATIC_SUCCESS = 100;
+	const int COVER_BONUS = 25;
+	Position pos = _candidates[index];
+	Tile *tile = _save->getTile(pos);
+	Position origin = _candidateOrigin;
+	Position target;
+	int score = 0;
+
+	// make sure we can't be seen here.
+	if (!_save->getTileEngine()->canTargetUnit(&origin, tile, &target, _aggroTarget, _unit) && !getSpottingUnits(pos))
+	{
+		pathfinding->calculate(_unit, pos);
+		int ambushTUs = pathfinding->getTotalTUCost();
+		// make sure we can move here
+		if (pathfinding->getStartDirection() != -1)
+		{
+			// make sure our enemy can reach here too.
+			pathfinding->calculate(_aggroTarget, pos);
+
+			if (pathfinding->getStartDirection() != -1)
+			{
+				score = BASE_SYSTEMATIC_SUCCESS - ambushTUs;
+				// ideally we'd like to be behind some cover, like say a window or a low wall.
+				if (_save->getTileEngine()->faceWindow(pos) != -1)
+				{
+					score += COVER_BONUS;
+				}
+				_candidateTUs[index] = ambushTUs;
+				_candidatePaths[index] = pathfinding->copyPath();
+			}
+		}
+	}
+	_candidateScores[index] = score;
+}
+
 /**
  * Decides if it worth our while to create an explosion here.
  * @param targetPos The target's position.
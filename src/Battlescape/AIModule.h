@@ -32,6 +32,7 @@ class BattleUnit;
 struct BattleAction;
 class BattlescapeState;
 class Node;
+class Pathfinding;
 
 enum AIMode { AI_PATROL, AI_AMBUSH, AI_COMBAT, AI_ESCAPE };
 /**
@@ -53,6 +54,10 @@ private:
 	std::vector<int> _reachable, _reachableWithAttack, _wasHitBy;
 	BattleActionType _reserve;
 	UnitFaction _targetFaction;
+	Position _candidateOrigin;
+	std::vector<Position> _candidates;
+	std::vector<int> _candidateScores, _candidateTUs;
+	std::vector<std::vector<int> > _candidatePaths;
 public:
 	/// Creates a new AIModule linked to the game and a certain unit.
 	AIModule(SavedBattleGame *save, BattleUnit *unit, Node *node);
@@ -92,6 +97,10 @@ public:
 	void evaluateAIMode();
 	/// Selects a suitable position from which to attack.
 	bool findFirePoint();
+	/// Scores a candidate position to attack from.
+	void scoreFirePoint(Pathfinding *pathfinding, int index);
+	/// Scores a candidate position to ambush from.
+	void scoreAmbushPoint(Pathfinding *pathfinding, int index);
 	/// Decides if we should throw a grenade/launch a missile to this position.
 	bool explosiveEfficacy(Position targetPos, BattleUnit *attackingUnit, int radius, int diff, bool grenade = false) const;
 	bool getNodeOfBestEfficacy(BattleAction *action);
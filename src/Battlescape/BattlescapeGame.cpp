@@ -332,6 +332,7 @@ bool BattlescapeGame::kneel(BattleUnit *bu)
 		if (bu->spendTimeUnits(tu))
 		{
 			bu->kneel(!bu->isKneeled());
+			_save->unitsChanged();
 			// kneeling or standing up can reveal new terrain or units. I guess.
 			getTileEngine()->calculateFOV(bu);
 			getMap()->cacheUnits();
@@ -1003,6 +1004,8 @@ void BattlescapeGame::popState()
 	}
 	_deleted.push_back(_states.front());
 	_states.pop_front();
+	// whatever the action was, units may have moved, died or been spotted
+	_save->unitsChanged();
 
 	// handle the end of this unit's actions
 	if (action.actor && noActionsPending(action.actor))
@@ -1728,6 +1731,7 @@ BattleUnit *BattlescapeGame::convertUnit(BattleUnit *unit)
 	getSave()->getTile(unit->getPosition())->setUnit(newUnit, _save->getTile(unit->getPosition() + Position(0,0,-1)));
 	newUnit->setPosition(unit->getPosition());
 	newUnit->setDirection(unit->getDirection());
+	getSave()->unitsChanged();
 	newUnit->setCache(0);
 	newUnit->setTimeUnits(0);
 	newUnit->setSpecialWeapon(getSave(), getMod());
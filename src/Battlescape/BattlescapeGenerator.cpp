@@ -1753,6 +1753,7 @@ void BattlescapeGenerator::fuelPowerSources()
  */
 void BattlescapeGenerator::explodePowerSources()
 {
+	_save->getTileEngine()->beginExplosionBatch();
 	for (int i = 0; i < _save->getMapSizeXYZ(); ++i)
 	{
 		if (_save->getTiles()[i]->getMapData(O_OBJECT)
@@ -1773,6 +1774,7 @@ void BattlescapeGenerator::explodePowerSources()
 		_save->getTileEngine()->explode(p, t->getExplosive(), DT_HE, t->getExplosive() / 10);
 		t = _save->getTileEngine()->checkForTerrainExplosions();
 	}
+	_save->getTileEngine()->endExplosionBatch();
 }
 
 /**
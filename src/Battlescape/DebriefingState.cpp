@@ -645,23 +645,15 @@ void DebriefingState::prepareDebriefing()
 		{
 			if ((*j)->isInBattlescape())
 			{
-				for (std::vector<Region*>::iterator k = _game->getSavedGame()->getRegions()->begin(); k != _game->getSavedGame()->getRegions()->end(); ++k)
+				if (Region *region = _game->getSavedGame()->locateRegion(**j))
 				{
-					if ((*k)->getRules()->insideRegion((*j)->getLongitude(), (*j)->getLatitude()))
-					{
-						_region = (*k);
-						_missionStatistics->region = _region->getRules()->getType();
-						break;
-					}
+					_region = region;
+					_missionStatistics->region = _region->getRules()->getType();
 				}
-				for (std::vector<Country*>::iterator k = _game->getSavedGame()->getCountries()->begin(); k != _game->getSavedGame()->getCountries()->end(); ++k)
+				if (Country *country = _game->getSavedGame()->locateCountry(**j))
 				{
-					if ((*k)->getRules()->insideCountry((*j)->getLongitude(), (*j)->getLatitude()))
-					{
-						_country = (*k);
-						_missionStatistics->country = _country->getRules()->getType();
-						break;
-					}
+					_country = country;
+					_missionStatistics->country = _country->getRules()->getType();
 				}
 				craft = (*j);
 				base = (*i);
@@ -709,23 +701,15 @@ void DebriefingState::prepareDebriefing()
 			target = "STR_BASE";
 			base->setInBattlescape(false);
 			base->cleanupDefenses(false);
-			for (std::vector<Region*>::iterator k = _game->getSavedGame()->getRegions()->begin(); k != _game->getSavedGame()->getRegions()->end(); ++k)
+			if (Region *region = _game->getSavedGame()->locateRegion(*base))
 			{
-				if ((*k)->getRules()->insideRegion(base->getLongitude(), base->getLatitude()))
-				{
-					_region = (*k);
-					_missionStatistics->region = _region->getRules()->getType();
-					break;
-				}
+				_region = region;
+				_missionStatistics->region = _region->getRules()->getType();
 			}
-			for (std::vector<Country*>::iterator k = _game->getSavedGame()->getCountries()->begin(); k != _game->getSavedGame()->getCountries()->end(); ++k)
+			if (Country *country = _game->getSavedGame()->locateCountry(*base))
 			{
-				if ((*k)->getRules()->insideCountry(base->getLongitude(), base->getLatitude()))
-				{
-					_country = (*k);
-					_missionStatistics->country= _country->getRules()->getType();
-					break;
-				}
+				_country = country;
+				_missionStatistics->country= _country->getRules()->getType();
 			}
 			// Loop through the UFOs and see which one is sitting on top of the base... that is probably the one attacking you.
 			for (std::vector<Ufo*>::iterator k = save->getUfos()->begin(); k != save->getUfos()->end(); ++k)
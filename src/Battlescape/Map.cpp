@@ -75,7 +75,7 @@ namespace OpenXcom
  * @param y Y position in pixels.
  * @param visibleMapHeight Current visible map height.
  */
-Map::Map(Game *game, int width, int height, int x, int y, int visibleMapHeight) : InteractiveSurface(width, height, x, y), _game(game), _arrow(0), _selectorX(0), _selectorY(0), _mouseX(0), _mouseY(0), _cursorType(CT_NORMAL), _cursorSize(1), _animFrame(0), _projectile(0), _projectileInFOV(false), _explosionInFOV(false), _launch(false), _visibleMapHeight(visibleMapHeight), _unitDying(false), _smoothingEngaged(false), _flashScreen(false)
+Map::Map(Game *game, int width, int height, int x, int y, int visibleMapHeight) : InteractiveSurface(width, height, x, y), _game(game), _arrow(0), _selectorX(0), _selectorY(0), _mouseX(0), _mouseY(0), _cursorType(CT_NORMAL), _cursorSize(1), _animFrame(0), _projectile(0), _projectileInFOV(false), _explosionInFOV(false), _launch(false), _visibleMapHeight(visibleMapHeight), _unitDying(false), _smoothingEngaged(false), _flashScreen(false), _cursorSet(0), _smokeSet(0), _floorobSet(0), _breathSet(0), _pathfindingSet(0), _bigExplosionSet(0), _hitSet(0)
 {
 	_iconHeight = _game->getMod()->getInterface("battlescape")->getElement("icons")->h;
 	_iconWidth = _game->getMod()->getInterface("battlescape")->getElement("icons")->w;
@@ -162,6 +162,15 @@ void Map::init()
 	{
 		_projectileSet = _game->getMod()->getSurfaceSet("UnderwaterProjectiles");
 	}
+
+	// look up the sprite sets once instead of every frame
+	_cursorSet = _game->getMod()->getSurfaceSet("CURSOR.PCK");
+	_smokeSet = _game->getMod()->getSurfaceSet("SMOKE.PCK");
+	_floorobSet = _game->getMod()->getSurfaceSet("FLOOROB.PCK");
+	_breathSet = _game->getMod()->getSurfaceSet("BREATH-1.PCK", false);
+	_pathfindingSet = _game->getMod()->getSurfaceSet("Pathfinding");
+	_bigExplosionSet = _game->getMod()->getSurfaceSet("X1.PCK");
+	_hitSet = _game->getMod()->getSurfaceSet("HIT.PCK");
 }
 
 /**
@@ -392,7 +401,9 @@ void Map::drawTerrain(Surface *surface)
 	{
 		for (int itX = beginX; itX <= endX; itX++)
 		{
-			for (int itY = beginY; itY <= endY; itY++)
+			int rowBegin = beginY, rowEnd = endY;
+			clipVisibleRows(surface, itX, itZ, &rowBegin, &rowEnd);
+			for (int itY = rowBegin; itY <= rowEnd; itY++)
 			{
 				mapPosition = Position(itX, itY, itZ);
 				_camera->convertMapToScreen(mapPosition, &screenPosition);
@@ -442,13 +453,13 @@ void Map::drawTerrain(Surface *surface)
 								else
 									frameNumber = 6; // red static crosshairs
 							}
-							tmpSurface = _game->getMod()->getSurfaceSet("CURSOR.PCK")->getFrame(frameNumber);
+							tmpSurface = _cursorSet->getFrame(frameNumber);
 							tmpSurface->blitNShade(surface, screenPosition.x, screenPosition.y, 0);
 						}
 						else if (_camera->getViewLevel() > itZ)
 						{
 							frameNumber = 2; // blue box
-							tmpSurface = _game->getMod()->getSurfaceSet("CURSOR.PCK")->getFrame(frameNumber);
+							tmpSurface = _cursorSet->getFrame(frameNumber);
 							tmpSurface->blitNShade(surface, screenPosition.x, screenPosition.y, 0);
 						}
 					}
@@ -490,7 +501,7 @@ void Map::drawTerrain(Surface *surface)
 								if (bu->getFire() > 0)
 								{
 									frameNumber = 4 + (_animFrame / 2);
-									tmpSurface = _game->getMod()->getSurfaceSet("SMOKE.PCK")->getFrame(frameNumber);
+									tmpSurface = _smokeSet->getFrame(frameNumber);
 									tmpSurface->blitNShade(surface, screenPosition.x + offset.x + tileOffset.x, screenPosition.y + offset.y + tileOffset.y, 0);
 								}
 							}
@@ -622,7 +633,7 @@ void Map::drawTerrain(Surface *surface)
 								int sprite = tileWest->getTopItemSprite();
 								if (sprite != -1)
 								{
-									tmpSurface = _game->getMod()->getSurfaceSet("FLOOROB.PCK")->getFrame(sprite);
+									tmpSurface = _floorobSet->getFrame(sprite);
 									tmpSurface->blitNShade(surface, screenPosition.x - tileOffset.x, screenPosition.y + tileWest->getTerrainLevel() + tileOffset.y, tileWestShade, true);
 								}
 								// Draw soldier
@@ -641,7 +652,7 @@ void Map::drawTerrain(Surface *surface)
 										if (westUnit->getFire() > 0)
 										{
 											frameNumber = 4 + (_animFrame / 2);
-											tmpSurface = _game->getMod()->getSurfaceSet("SMOKE.PCK")->getFrame(frameNumber);
+											tmpSurface = _smokeSet->getFrame(frameNumber);
 											tmpSurface->blitNShade(surface, screenPosition.x - tileOffset.x + offset.x, screenPosition.y + tileOffset.y + offset.y, 0, true);
 										}
 									}
@@ -673,7 +684,7 @@ void Map::drawTerrain(Surface *surface)
 									{
 										frameNumber += (_animFrame / 2) + tileWest->getAnimationOffset();
 									}
-									tmpSurface = _game->getMod()->getSurfaceSet("SMOKE.PCK")->getFrame(frameNumber);
+									tmpSurface = _smokeSet->getFrame(frameNumber);
 									tmpSurface->blitNShade(surface, screenPosition.x - tileOffset.x, screenPosition.y + tileOffset.y, shade, true);
 								}
 								// Draw object
@@ -730,7 +741,7 @@ void Map::drawTerrain(Surface *surface)
 						int sprite = tile->getTopItemSprite();
 						if (sprite != -1)
 						{
-							tmpSurface = _game->getMod()->getSurfaceSet("FLOOROB.PCK")->getFrame(sprite);
+							tmpSurface = _floorobSet->getFrame(sprite);
 							tmpSurface->blitNShade(surface, screenPosition.x, screenPosition.y + tile->getTerrainLevel(), tileShade, false);
 						}
 
@@ -840,12 +851,12 @@ void Map::drawTerrain(Surface *surface)
 							if (unit->getFire() > 0)
 							{
 								frameNumber = 4 + (_animFrame / 2);
-								tmpSurface = _game->getMod()->getSurfaceSet("SMOKE.PCK")->getFrame(frameNumber);
+								tmpSurface = _smokeSet->getFrame(frameNumber);
 								tmpSurface->blitNShade(surface, screenPosition.x + offset.x, screenPosition.y + offset.y, 0);
 							}
 							if (unit->getBreathFrame() > 0)
 							{
-								tmpSurface = _game->getMod()->getSurfaceSet("BREATH-1.PCK")->getFrame(unit->getBreathFrame() - 1);
+								tmpSurface = _breathSet ? _breathSet->getFrame(unit->getBreathFrame() - 1) : 0;
 								// lower the bubbles for shorter or kneeling units.
 								offset.y += (22 - unit->getHeight());
 								if (tmpSurface)
@@ -881,7 +892,7 @@ void Map::drawTerrain(Surface *surface)
 								if (tunit->getFire() > 0)
 								{
 									frameNumber = 4 + (_animFrame / 2);
-									tmpSurface = _game->getMod()->getSurfaceSet("SMOKE.PCK")->getFrame(frameNumber);
+									tmpSurface = _smokeSet->getFrame(frameNumber);
 									tmpSurface->blitNShade(surface, screenPosition.x + offset.x, screenPosition.y + offset.y, 0);
 								}
 							}
@@ -915,7 +926,7 @@ void Map::drawTerrain(Surface *surface)
 						{
 							frameNumber += (_animFrame / 2) + tile->getAnimationOffset();
 						}
-						tmpSurface = _game->getMod()->getSurfaceSet("SMOKE.PCK")->getFrame(frameNumber);
+						tmpSurface = _smokeSet->getFrame(frameNumber);
 						tmpSurface->blitNShade(surface, screenPosition.x, screenPosition.y, shade);
 					}
 
@@ -946,13 +957,13 @@ void Map::drawTerrain(Surface *surface)
 					{
 						if (itZ > 0 && tile->hasNoFloor(tileBelow))
 						{
-							tmpSurface = _game->getMod()->getSurfaceSet("Pathfinding")->getFrame(11);
+							tmpSurface = _pathfindingSet->getFrame(11);
 							if (tmpSurface)
 							{
 								tmpSurface->blitNShade(surface, screenPosition.x, screenPosition.y+2, 0, false, tile->getMarkerColor());
 							}
 						}
-						tmpSurface = _game->getMod()->getSurfaceSet("Pathfinding")->getFrame(tile->getPreview());
+						tmpSurface = _pathfindingSet->getFrame(tile->getPreview());
 						if (tmpSurface)
 						{
 							tmpSurface->blitNShade(surface, screenPosition.x, screenPosition.y + tile->getTerrainLevel(), 0, false, tileColor);
@@ -987,7 +998,7 @@ void Map::drawTerrain(Surface *surface)
 								else
 									frameNumber = 6; // red static crosshairs
 							}
-							tmpSurface = _game->getMod()->getSurfaceSet("CURSOR.PCK")->getFrame(frameNumber);
+							tmpSurface = _cursorSet->getFrame(frameNumber);
 							tmpSurface->blitNShade(surface, screenPosition.x, screenPosition.y, 0);
 
 							// UFO extender accuracy: display adjusted accuracy value on crosshair in real-time.
@@ -1065,13 +1076,13 @@ void Map::drawTerrain(Surface *surface)
 						else if (_camera->getViewLevel() > itZ)
 						{
 							frameNumber = 5; // blue box
-							tmpSurface = _game->getMod()->getSurfaceSet("CURSOR.PCK")->getFrame(frameNumber);
+							tmpSurface = _cursorSet->getFrame(frameNumber);
 							tmpSurface->blitNShade(surface, screenPosition.x, screenPosition.y, 0);
 						}
 						if (_cursorType > 2 && _camera->getViewLevel() == itZ)
 						{
 							int frame[6] = {0, 0, 0, 11, 13, 15};
-							tmpSurface = _game->getMod()->getSurfaceSet("CURSOR.PCK")->getFrame(frame[_cursorType] + (_animFrame / 4));
+							tmpSurface = _cursorSet->getFrame(frame[_cursorType] + (_animFrame / 4));
 							tmpSurface->blitNShade(surface, screenPosition.x, screenPosition.y, 0);
 						}
 					}
@@ -1087,7 +1098,7 @@ void Map::drawTerrain(Surface *surface)
 						{
 							if (waypXOff == 2 && waypYOff == 2)
 							{
-								tmpSurface = _game->getMod()->getSurfaceSet("CURSOR.PCK")->getFrame(7);
+								tmpSurface = _cursorSet->getFrame(7);
 								tmpSurface->blitNShade(surface, screenPosition.x, screenPosition.y, 0);
 							}
 							if (_save->getBattleGame()->getCurrentAction()->type == BA_LAUNCH)
@@ -1120,7 +1131,9 @@ void Map::drawTerrain(Surface *surface)
 		{
 			for (int itX = beginX; itX <= endX; itX++)
 			{
-				for (int itY = beginY; itY <= endY; itY++)
+				int rowBegin = beginY, rowEnd = endY;
+				clipVisibleRows(surface, itX, itZ, &rowBegin, &rowEnd);
+				for (int itY = rowBegin; itY <= rowEnd; itY++)
 				{
 					mapPosition = Position(itX, itY, itZ);
 					_camera->convertMapToScreen(mapPosition, &screenPosition);
@@ -1139,14 +1152,14 @@ void Map::drawTerrain(Surface *surface)
 						{
 							if (itZ > 0 && tile->hasNoFloor(tileBelow))
 							{
-								tmpSurface = _game->getMod()->getSurfaceSet("Pathfinding")->getFrame(23);
+								tmpSurface = _pathfindingSet->getFrame(23);
 								if (tmpSurface)
 								{
 									tmpSurface->blitNShade(surface, screenPosition.x, screenPosition.y+2, 0, false, tile->getMarkerColor());
 								}
 							}
 							int overlay = tile->getPreview() + 12;
-							tmpSurface = _game->getMod()->getSurfaceSet("Pathfinding")->getFrame(overlay);
+							tmpSurface = _pathfindingSet->getFrame(overlay);
 							if (tmpSurface)
 							{
 								tmpSurface->blitNShade(surface, screenPosition.x, screenPosition.y - adjustment, 0, false, tile->getMarkerColor());
@@ -1231,18 +1244,18 @@ void Map::drawTerrain(Surface *surface)
 				{
 					if ((*i)->getCurrentFrame() >= 0)
 					{
-						tmpSurface = _game->getMod()->getSurfaceSet("X1.PCK")->getFrame((*i)->getCurrentFrame());
+						tmpSurface = _bigExplosionSet->getFrame((*i)->getCurrentFrame());
 						tmpSurface->blitNShade(surface, bulletPositionScreen.x - (tmpSurface->getWidth() / 2), bulletPositionScreen.y - (tmpSurface->getHeight() / 2), 0);
 					}
 				}
 				else if ((*i)->isHit())
 				{
-					tmpSurface = _game->getMod()->getSurfaceSet("HIT.PCK")->getFrame((*i)->getCurrentFrame());
+					tmpSurface = _hitSet->getFrame((*i)->getCurrentFrame());
 					tmpSurface->blitNShade(surface, bulletPositionScreen.x - 15, bulletPositionScreen.y - 25, 0);
 				}
 				else
 				{
-					tmpSurface = _game->getMod()->getSurfaceSet("SMOKE.PCK")->getFrame((*i)->getCurrentFrame());
+					tmpSurface = _smokeSet->getFrame((*i)->getCurrentFrame());
 					tmpSurface->blitNShade(surface, bulletPositionScreen.x - 15, bulletPositionScreen.y - 15, 0);
 				}
 			}
@@ -1251,6 +1264,35 @@ void Map::drawTerrain(Surface *surface)
 	surface->unlock();
 }
 
+/**
+ * Narrows down a column of tiles to the ones whose sprites can
+ * overlap the surface, so the rest of the column isn't visited at all.
+ * The range may still include a few tiles just off the surface.
+ * @param surface The surface being drawn on.
+ * @param x X position of the column on the map.
+ * @param z Level of the column on the map.
+ * @param beginY First row of the column, gets moved up.
+ * @param endY Last row of the column, gets moved down.
+ */
+void Map::clipVisibleRows(Surface *surface, int x, int z, int *beginY, int *endY) const
+{
+	int halfWidth = _spriteWidth / 2;
+	int quarterWidth = _spriteWidth / 4;
+	int levelHeight = (_spriteHeight + _spriteWidth / 4) / 2;
+	if (halfWidth <= 0 || quarterWidth <= 0)
+		return;
+	Position offset = _camera->getMapOffset();
+	// same maths as Camera::convertMapToScreen, solved for y
+	int screenX = x * halfWidth + offset.x;
+	int screenY = x * quarterWidth - z * levelHeight + offset.y;
+	int first = std::max(FloorDiv(screenX - surface->getWidth() - _spriteWidth, halfWidth),
+						FloorDiv(-_spriteHeight - screenY, quarterWidth));
+	int last = std::min(FloorDiv(screenX + _spriteWidth, halfWidth),
+						FloorDiv(surface->getHeight() + _spriteHeight - screenY, quarterWidth));
+	*beginY = std::max(*beginY, first);
+	*endY = std::min(*endY, last);
+}
+
 /**
  * Handles mouse presses on the map.
  * @param action Pointer to an action.
@@ -67,8 +67,10 @@ private:
 	PathPreview _previewSetting;
 	Text *_txtAccuracy;
 	SurfaceSet *_projectileSet;
+	SurfaceSet *_cursorSet, *_smokeSet, *_floorobSet, *_breathSet, *_pathfindingSet, *_bigExplosionSet, *_hitSet;
 
 	void drawTerrain(Surface *surface);
+	void clipVisibleRows(Surface *surface, int x, int z, int *beginY, int *endY) const;
 	int getTerrainLevel(const Position& pos, int size) const;
 	int _iconHeight, _iconWidth, _messageColor;
 	const std::vector<Uint8> *_transparencies;
@@ -138,6 +138,7 @@ void MeleeAttackBState::think()
 	if (_unit->getSpecialAbility() == SPECAB_BURNFLOOR || _unit->getSpecialAbility() == SPECAB_BURN_AND_EXPLODE)
 	{
 		_parent->getSave()->getTile(_action.target)->ignite(15);
+		_parent->getSave()->fireChanged();
 	}
 	// Determine if the attack was successful
 	// we do this here instead of letting the explosionBState take care of damage and casualty checking
@@ -18,8 +18,11 @@
  */
 #include <list>
 #include <algorithm>
+#include <queue>
+#include <set>
+#include <functional>
+#include <cmath>
 #include "Pathfinding.h"
-#include "PathfindingOpenSet.h"
 #include "../Savegame/SavedBattleGame.h"
 #include "../Savegame/Tile.h"
 #include "../Mod/Armor.h"
@@ -38,9 +41,11 @@ int Pathfinding::green = 4;
  * Sets up a Pathfinding.
  * @param save pointer to SavedBattleGame object.
  */
-Pathfinding::Pathfinding(SavedBattleGame *save) : _save(save), _unit(0), _pathPreviewed(false), _strafeMove(false), _totalTUCost(0), _modifierUsed(false), _movementType(MT_WALK)
+Pathfinding::Pathfinding(SavedBattleGame *save) : _save(save), _searchId(0), _unit(0), _pathPreviewed(false), _strafeMove(false), _totalTUCost(0), _modifierUsed(false), _movementType(MT_WALK), _useCorridor(false), _terrainOnly(false)
 {
 	_size = _save->getMapSizeXYZ();
+	_clustersX = (_save->getMapSizeX() + CLUSTER_SIZE - 1) / CLUSTER_SIZE;
+	_clustersY = (_save->getMapSizeY() + CLUSTER_SIZE - 1) / CLUSTER_SIZE;
 	// Initialize one node per tile
 	_nodes.reserve(_size);
 	Position p;
@@ -61,13 +66,32 @@ Pathfinding::~Pathfinding()
 }
 
 /**
- * Gets the Node on a given position on the map.
+ * Starts a new search. Instead of resetting every node on the map,
+ * nodes are reset as soon as they are used by a newer search.
+ */
+void Pathfinding::newSearch()
+{
+	if (++_searchId == 0)
+	{
+		// the counter wrapped around, make sure no node looks current
+		for (std::vector<PathfindingNode>::iterator it = _nodes.begin(); it != _nodes.end(); ++it)
+			it->startSearch(0);
+		_searchId = 1;
+	}
+	_openSet.clear();
+}
+
+/**
+ * Gets the Node on a given position on the map, reset if the
+ * current search has not used it yet.
  * @param pos Position.
  * @return Pointer to node.
  */
 PathfindingNode *Pathfinding::getNode(Position pos)
 {
-	return &_nodes[_save->getTileIndex(pos)];
+	PathfindingNode *node = &_nodes[_save->getTileIndex(pos)];
+	node->startSearch(_searchId);
+	return node;
 }
 
 /**
@@ -164,13 +188,270 @@ void Pathfinding::calculate(BattleUnit *unit, Position endPosition, BattleUnit *
 	{
 		abortPath(); // if bresenham failed, we shouldn't keep the path it was attempting, in case A* fails too.
 	}
-	// Now try through A*.
-	if (!aStarPath(startPosition, endPosition, target, sneak, maxTUCost))
+	// Now try through the map blocks first, then through A* over the whole map.
+	if (!hierarchicalPath(startPosition, endPosition, target, sneak, maxTUCost) &&
+		!aStarPath(startPosition, endPosition, target, sneak, maxTUCost))
 	{
 		abortPath();
 	}
 }
 
+/**
+ * Gets the cluster a position belongs to. Clusters are the 10x10 map blocks,
+ * spanning all the levels of the map.
+ * @param pos Position.
+ * @return Cluster index.
+ */
+int Pathfinding::getCluster(Position pos) const
+{
+	return (pos.x / CLUSTER_SIZE) + (pos.y / CLUSTER_SIZE) * _clustersX;
+}
+
+/**
+ * Finds the moves out of a cluster, for the current unit's movement type and size.
+ * Every run of neighbouring edge tiles that can be crossed gets one exit in the
+ * middle, or one at each end when the run is long.
+ * @param cache The cache of the cluster.
+ * @param cluster Cluster index.
+ */
+void Pathfinding::findClusterExits(ClusterCache &cache, int cluster)
+{
+	cache.exits.clear();
+	cache.edges.clear();
+	int x1 = (cluster % _clustersX) * CLUSTER_SIZE;
+	int y1 = (cluster / _clustersX) * CLUSTER_SIZE;
+	int x2 = std::min(x1 + CLUSTER_SIZE, _save->getMapSizeX()) - 1;
+	int y2 = std::min(y1 + CLUSTER_SIZE, _save->getMapSizeY()) - 1;
+	std::vector<ClusterExit> run;
+	for (int direction = 0; direction < 8; direction += 2)
+	{
+		int length = (direction == 0 || direction == 4) ? x2 - x1 + 1 : y2 - y1 + 1;
+		for (int z = 0; z < _save->getMapSizeZ(); ++z)
+		{
+			for (int i = 0; i <= length; ++i)
+			{
+				int cost = 255;
+				Position pos, endPos;
+				if (i < length)
+				{
+					switch (direction)
+					{
+					case 0: pos = Position(x1 + i, y1, z); break;
+					case 2: pos = Position(x2, y1 + i, z); break;
+					case 4: pos = Position(x1 + i, y2, z); break;
+					default: pos = Position(x1, y1 + i, z); break;
+					}
+					cost = getTUCost(pos, direction, &endPos, _unit, 0, false);
+				}
+				if (cost < 255)
+				{
+					run.push_back(ClusterExit(_save->getTileIndex(pos), _save->getTileIndex(endPos), cost));
+				}
+				else if (!run.empty())
+				{
+					if (run.size() >= 6)
+					{
+						cache.exits.push_back(run.front());
+						cache.exits.push_back(run.back());
+					}
+					else
+					{
+						cache.exits.push_back(run[run.size() / 2]);
+					}
+					run.clear();
+				}
+			}
+		}
+	}
+	cache.valid = true;
+}
+
+/**
+ * Gets the cheapest moves from a tile to the exits of its cluster, and through them
+ * into the neighbouring clusters. The moves are found with Dijkstra's algorithm
+ * inside the cluster, without regard to units, and kept until the terrain changes.
+ * @param graph The cluster caches for the current movement type and unit size.
+ * @param tileIndex The tile to start from.
+ * @return The moves into the neighbouring clusters.
+ */
+const std::vector<Pathfinding::ClusterEdge> &Pathfinding::getClusterEdges(std::vector<ClusterCache> &graph, int tileIndex)
+{
+	Position start;
+	_save->getTileCoords(tileIndex, &start.x, &start.y, &start.z);
+	int cluster = getCluster(start);
+	ClusterCache &cache = graph[cluster];
+	if (!cache.valid)
+	{
+		findClusterExits(cache, cluster);
+	}
+	std::map<int, std::vector<ClusterEdge> >::iterator found = cache.edges.find(tileIndex);
+	if (found != cache.edges.end())
+	{
+		return found->second;
+	}
+
+	std::vector<ClusterEdge> &edges = cache.edges[tileIndex];
+	newSearch();
+	PathfindingNode *startNode = getNode(start);
+	startNode->connect(0, 0, 0);
+	_openSet.push(startNode);
+	while (!_openSet.empty())
+	{
+		PathfindingNode *currentNode = _openSet.pop();
+		Position const &currentPos = currentNode->getPosition();
+		currentNode->setChecked();
+		for (int direction = 0; direction < 10; direction++)
+		{
+			Position nextPos;
+			int tuCost = getTUCost(currentPos, direction, &nextPos, _unit, 0, false);
+			if (tuCost >= 255 || getCluster(nextPos) != cluster)
+				continue;
+			PathfindingNode *nextNode = getNode(nextPos);
+			if (nextNode->isChecked())
+				continue;
+			int totalTuCost = currentNode->getTUCost(false) + tuCost;
+			if (!nextNode->inOpenSet() || nextNode->getTUCost(false) > totalTuCost)
+			{
+				nextNode->connect(totalTuCost, currentNode, direction);
+				_openSet.push(nextNode);
+			}
+		}
+	}
+	for (std::vector<ClusterExit>::const_iterator i = cache.exits.begin(); i != cache.exits.end(); ++i)
+	{
+		Position exitPos;
+		_save->getTileCoords(i->from, &exitPos.x, &exitPos.y, &exitPos.z);
+		PathfindingNode *exitNode = getNode(exitPos);
+		if (exitNode->isChecked())
+		{
+			edges.push_back(ClusterEdge(i->to, exitNode->getTUCost(false) + i->cost));
+		}
+	}
+	return edges;
+}
+
+/**
+ * Tries to find a path between two positions that are at least one map block apart.
+ * First finds a route through the cached moves between the map blocks, then runs A*
+ * limited to the blocks along that route, so the search does not flood the whole map.
+ * The route isn't always the cheapest one, so this is only used for the AI; the
+ * player's units always get the optimal path from the normal A* search.
+ * The cached moves only depend on the terrain, units and fire are left out.
+ * The unit information and movement type must have already been set.
+ * @param startPosition The position to start from.
+ * @param endPosition The position we want to reach.
+ * @param target Target of the path.
+ * @param sneak Is the unit sneaking?
+ * @param maxTUCost Maximum time units the path can cost.
+ * @return True if a path was found, false if the normal A* search should be used instead.
+ */
+bool Pathfinding::hierarchicalPath(Position startPosition, Position endPosition, BattleUnit *target, bool sneak, int maxTUCost)
+{
+	if (target && maxTUCost == 10000) // missiles don't care about TUs
+		return false;
+	if (_unit->getFaction() == FACTION_PLAYER)
+		return false;
+	int startCluster = getCluster(startPosition);
+	int endCluster = getCluster(endPosition);
+	if (abs(startCluster % _clustersX - endCluster % _clustersX) < 2 && abs(startCluster / _clustersX - endCluster / _clustersX) < 2)
+		return false;
+
+	std::vector<ClusterCache> &graph = _clusterGraphs[_movementType * 4 + _unit->getArmor()->getSize()];
+	if (graph.empty())
+	{
+		graph.resize(_clustersX * _clustersY);
+	}
+
+	// search the cluster graph, tile indices are the nodes
+	typedef std::pair<int, int> OpenEntry; // estimated total cost, tile index
+	std::priority_queue<OpenEntry, std::vector<OpenEntry>, std::greater<OpenEntry> > open;
+	std::map<int, int> costs, previous;
+	std::set<int> closed;
+	int startIndex = _save->getTileIndex(startPosition);
+	int goal = -1;
+	costs[startIndex] = 0;
+	open.push(std::make_pair(0, startIndex));
+	_terrainOnly = true;
+	while (!open.empty())
+	{
+		int current = open.top().second;
+		open.pop();
+		if (!closed.insert(current).second)
+			continue;
+		Position currentPos;
+		_save->getTileCoords(current, &currentPos.x, &currentPos.y, &currentPos.z);
+		if (getCluster(currentPos) == endCluster)
+		{
+			goal = current;
+			break;
+		}
+		const std::vector<ClusterEdge> &edges = getClusterEdges(graph, current);
+		for (std::vector<ClusterEdge>::const_iterator i = edges.begin(); i != edges.end(); ++i)
+		{
+			int cost = costs[current] + i->cost;
+			if (cost > maxTUCost || closed.count(i->to))
+				continue;
+			std::map<int, int>::iterator known = costs.find(i->to);
+			if (known == costs.end() || known->second > cost)
+			{
+				costs[i->to] = cost;
+				previous[i->to] = current;
+				Position d;
+				_save->getTileCoords(i->to, &d.x, &d.y, &d.z);
+				d = endPosition - d;
+				d *= d;
+				open.push(std::make_pair(cost + (int)(4 * sqrt((double)d.x + d.y + d.z)), i->to));
+			}
+		}
+	}
+	_terrainOnly = false;
+	if (goal == -1)
+		return false;
+
+	// refine the route with A* through the clusters it passes
+	_corridor.assign(_clustersX * _clustersY, false);
+	_corridor[startCluster] = true;
+	for (int node = goal; node != startIndex; node = previous[node])
+	{
+		Position pos;
+		_save->getTileCoords(node, &pos.x, &pos.y, &pos.z);
+		_corridor[getCluster(pos)] = true;
+	}
+	_useCorridor = true;
+	bool found = aStarPath(startPosition, endPosition, target, sneak, maxTUCost);
+	_useCorridor = false;
+	return found;
+}
+
+/**
+ * Drops the cached cluster moves around a tile whose terrain changed.
+ * Moves out of a cluster look up to two tiles around them (walls of the
+ * neighbouring tiles, large units), so nearby clusters are dropped too.
+ * @param pos Position of the tile.
+ */
+void Pathfinding::terrainChanged(Position pos)
+{
+	if (_clusterGraphs.empty())
+		return;
+	Position low = Position(std::max(0, pos.x - 2), std::max(0, pos.y - 2), 0);
+	Position high = Position(std::min(_save->getMapSizeX() - 1, pos.x + 2), std::min(_save->getMapSizeY() - 1, pos.y + 2), 0);
+	for (std::map<int, std::vector<ClusterCache> >::iterator graph = _clusterGraphs.begin(); graph != _clusterGraphs.end(); ++graph)
+	{
+		if (graph->second.empty())
+			continue;
+		for (int y = low.y / CLUSTER_SIZE; y <= high.y / CLUSTER_SIZE; ++y)
+		{
+			for (int x = low.x / CLUSTER_SIZE; x <= high.x / CLUSTER_SIZE; ++x)
+			{
+				ClusterCache &cache = graph->second[x + y * _clustersX];
+				cache.valid = false;
+				cache.exits.clear();
+				cache.edges.clear();
+			}
+		}
+	}
+}
+
 /**
  * Calculates the shortest path using a simple A-Star algorithm.
  * The unit information and movement type must have already been set.
@@ -184,20 +465,17 @@ void Pathfinding::calculate(BattleUnit *unit, Position endPosition, BattleUnit *
  */
 bool Pathfinding::aStarPath(Position startPosition, Position endPosition, BattleUnit *target, bool sneak, int maxTUCost)
 {
-	// reset every node, so we have to check them all
-	for (std::vector<PathfindingNode>::iterator it = _nodes.begin(); it != _nodes.end(); ++it)
-		it->reset();
+	newSearch();
 
 	// start position is the first one in our "open" list
 	PathfindingNode *start = getNode(startPosition);
 	start->connect(0, 0, 0, endPosition);
-	PathfindingOpenSet openList;
-	openList.push(start);
+	_openSet.push(start);
 	bool missile = (target && maxTUCost == 10000);
 	// if the open list is empty, we've reached the end
-	while (!openList.empty())
+	while (!_openSet.empty())
 	{
-		PathfindingNode *currentNode = openList.pop();
+		PathfindingNode *currentNode = _openSet.pop();
 		Position const &currentPos = currentNode->getPosition();
 		currentNode->setChecked();
 		if (currentPos == endPosition) // We found our target.
@@ -219,6 +497,8 @@ bool Pathfinding::aStarPath(Position startPosition, Position endPosition, Battle
 			int tuCost = getTUCost(currentPos, direction, &nextPos, _unit, target, missile);
 			if (tuCost >= 255) // Skip unreachable / blocked
 				continue;
+			if (_useCorridor && !_corridor[getCluster(nextPos)]) // Stay on the route through the map blocks
+				continue;
 			if (sneak && _save->getTile(nextPos)->getVisible()) tuCost *= 2; // avoid being seen
 			PathfindingNode *nextNode = getNode(nextPos);
 			if (nextNode->isChecked()) // Our algorithm means this node is already at minimum cost.
@@ -228,7 +508,7 @@ bool Pathfinding::aStarPath(Position startPosition, Position endPosition, Battle
 			if ((!nextNode->inOpenSet() || nextNode->getTUCost(missile) > _totalTUCost) && _totalTUCost <= maxTUCost)
 			{
 				nextNode->connect(_totalTUCost, currentNode, direction, endPosition);
-				openList.push(nextNode);
+				_openSet.push(nextNode);
 			}
 		}
 	}
@@ -324,7 +604,7 @@ int Pathfinding::getTUCost(Position startPosition, int direction, Position *endP
 						fellDown = true;
 					}
 			}
-			else if (!missile && _movementType == MT_FLY && belowDestination && belowDestination->getUnit() && belowDestination->getUnit() != unit)
+			else if (!missile && !_terrainOnly && _movementType == MT_FLY && belowDestination && belowDestination->getUnit() && belowDestination->getUnit() != unit)
 			{
 				// 2 or more voxels poking into this tile = no go
 				if (belowDestination->getUnit()->getHeight() + belowDestination->getUnit()->getFloatHeight() - belowDestination->getTerrainLevel() > 26)
@@ -433,13 +713,14 @@ int Pathfinding::getTUCost(Position startPosition, int direction, Position *endP
 				cost = (int)((double)cost * 1.5);
 			}
 			cost += wallcost;
-			if (_unit->getFaction() != FACTION_PLAYER &&
+			if (!_terrainOnly &&
+				_unit->getFaction() != FACTION_PLAYER &&
 				_unit->getSpecialAbility() < SPECAB_BURNFLOOR &&
 				destinationTile->getFire() > 0)
 				cost += 32; // try to find a better path, but don't exclude this path entirely.
 
 			// TFTD thing: tiles on fire are cost 2 TUs more for whatever reason.
-			if (_save->getDepth() > 0 && destinationTile->getFire() > 0)
+			if (!_terrainOnly && _save->getDepth() > 0 && destinationTile->getFire() > 0)
 			{
 				cost += 2;
 			}
@@ -614,7 +895,7 @@ bool Pathfinding::isBlocked(Tile *tile, const int part, BattleUnit *missileTarge
 			tileNorth->getMapData(O_OBJECT)->getBigWall() == BIGWALLEASTANDSOUTH))
 			return true; // blocking part
 	}
-	if (part == O_FLOOR)
+	if (part == O_FLOOR && !_terrainOnly)
 	{
 		BattleUnit *unit = tile->getUnit();
 		if (unit != 0)
@@ -1138,29 +1419,79 @@ bool Pathfinding::bresenhamPath(Position origin, Position target, BattleUnit *ta
 	return true;
 }
 
+/**
+ * Gets everything that affects which tiles a unit can reach and at what cost:
+ * its own position and energy, and the version numbers of the terrain, the
+ * fires and the other units, which go up whenever any of them change.
+ * @param unit Pointer to the unit.
+ * @param state Vector to fill with the state.
+ */
+void Pathfinding::getReachableState(BattleUnit *unit, std::vector<int> &state) const
+{
+	state.clear();
+	state.push_back(_save->getTileIndex(unit->getPosition()));
+	state.push_back(unit->getEnergy());
+	state.push_back(_movementType);
+	state.push_back(unit->getFaction());
+	state.push_back(_save->getTurn());
+	state.push_back(_save->getTerrainVersion());
+	state.push_back(_save->getFireVersion());
+	state.push_back(_save->getUnitsVersion());
+	state.push_back(unit->getUnitsSpottedThisTurn().size());
+}
+
 /**
  * Locates all tiles reachable to @a *unit with a TU cost no more than @a tuMax.
- * Uses Dijkstra's algorithm.
+ * Uses Dijkstra's algorithm. The cost of every tile is kept, so later calls for
+ * the same unit with the same or a smaller budget (like the AI checking where it
+ * can go and still shoot) only filter the result, until anything changes that
+ * affects the unit's movement.
  * @param unit Pointer to the unit.
  * @param tuMax The maximum cost of the path to each tile.
  * @return An array of reachable tiles, sorted in ascending order of cost. The first tile is the start location.
  */
 std::vector<int> Pathfinding::findReachable(BattleUnit *unit, int tuMax)
 {
-	Position start = unit->getPosition();
-	int energyMax = unit->getEnergy();
-	for (std::vector<PathfindingNode>::iterator it = _nodes.begin(); it != _nodes.end(); ++it)
+	std::vector<int> state;
+	getReachableState(unit, state);
+	ReachableCache &cache = _reachableCache[unit->getId()];
+	if (tuMax > cache.tuMax || state != cache.state)
 	{
-		it->reset();
+		calculateReachable(unit, tuMax, cache.tiles);
+		cache.tuMax = tuMax;
+		cache.state.swap(state);
 	}
+	std::vector<int> tiles;
+	tiles.reserve(cache.tiles.size());
+	for (std::vector<std::pair<int, int> >::const_iterator i = cache.tiles.begin(); i != cache.tiles.end(); ++i)
+	{
+		// the start location is always reachable, even without any TUs to spare
+		if (i != cache.tiles.begin() && i->second > tuMax)
+			break;
+		tiles.push_back(i->first);
+	}
+	return tiles;
+}
+
+/**
+ * Calculates the cost of all tiles reachable to @a *unit with a TU cost no more than @a tuMax.
+ * Uses Dijkstra's algorithm.
+ * @param unit Pointer to the unit.
+ * @param tuMax The maximum cost of the path to each tile.
+ * @param tiles Vector to fill with pairs of tile index and cost, sorted in ascending order of cost.
+ */
+void Pathfinding::calculateReachable(BattleUnit *unit, int tuMax, std::vector<std::pair<int, int> > &tiles)
+{
+	Position start = unit->getPosition();
+	int energyMax = unit->getEnergy();
+	newSearch();
 	PathfindingNode *startNode = getNode(start);
 	startNode->connect(0, 0, 0);
-	PathfindingOpenSet unvisited;
-	unvisited.push(startNode);
+	_openSet.push(startNode);
 	std::vector<PathfindingNode*> reachable;
-	while (!unvisited.empty())
+	while (!_openSet.empty())
 	{
-		PathfindingNode *currentNode = unvisited.pop();
+		PathfindingNode *currentNode = _openSet.pop();
 		Position const &currentPos = currentNode->getPosition();
 
 		// Try all reachable neighbours.
@@ -1181,20 +1512,19 @@ std::vector<int> Pathfinding::findReachable(BattleUnit *unit, int tuMax)
 			if (!nextNode->inOpenSet() || nextNode->getTUCost(false) > totalTuCost)
 			{
 				nextNode->connect(totalTuCost, currentNode, direction);
-				unvisited.push(nextNode);
+				_openSet.push(nextNode);
 			}
 		}
 		currentNode->setChecked();
 		reachable.push_back(currentNode);
 	}
 	std::sort(reachable.begin(), reachable.end(), MinNodeCosts());
-	std::vector<int> tiles;
+	tiles.clear();
 	tiles.reserve(reachable.size());
 	for (std::vector<PathfindingNode*>::const_iterator it = reachable.begin(); it != reachable.end(); ++it)
 	{
-		tiles.push_back(_save->getTileIndex((*it)->getPosition()));
+		tiles.push_back(std::make_pair(_save->getTileIndex((*it)->getPosition()), (*it)->getTUCost(false)));
 	}
-	return tiles;
 }
 
 /**
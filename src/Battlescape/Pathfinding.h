@@ -18,8 +18,10 @@
  * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
  */
 #include <vector>
+#include <map>
 #include "Position.h"
 #include "PathfindingNode.h"
+#include "PathfindingOpenSet.h"
 #include "../Mod/MapData.h"
 
 namespace OpenXcom
@@ -37,6 +39,8 @@ class Pathfinding
 private:
 	SavedBattleGame *_save;
 	std::vector<PathfindingNode> _nodes;
+	unsigned int _searchId;
+	PathfindingOpenSet _openSet;
 	int _size;
 	BattleUnit *_unit;
 	bool _pathPreviewed;
@@ -44,6 +48,57 @@ private:
 	int _totalTUCost;
 	bool _modifierUsed;
 	MovementType _movementType;
+	static const int CLUSTER_SIZE = 10;
+	/// A move from a tile on the edge of a cluster into the neighbouring cluster.
+	struct ClusterExit
+	{
+		int from, to, cost;
+		ClusterExit(int from_, int to_, int cost_) : from(from_), to(to_), cost(cost_) {}
+	};
+	/// The cheapest way from a tile inside a cluster to a tile in a neighbouring cluster.
+	struct ClusterEdge
+	{
+		int to, cost;
+		ClusterEdge(int to_, int cost_) : to(to_), cost(cost_) {}
+	};
+	/// The cached moves through one map block, for a single movement type and unit size.
+	struct ClusterCache
+	{
+		bool valid;
+		std::vector<ClusterExit> exits;
+		std::map<int, std::vector<ClusterEdge> > edges;
+		ClusterCache() : valid(false) {}
+	};
+	/// The cost of every tile a unit can reach, kept until anything that affects its movement changes.
+	struct ReachableCache
+	{
+		std::vector<std::pair<int, int> > tiles;
+		std::vector<int> state;
+		int tuMax;
+		ReachableCache() : tuMax(-1) {}
+	};
+	std::map<int, ReachableCache> _reachableCache;
+	int _clustersX, _clustersY;
+	std::map<int, std::vector<ClusterCache> > _clusterGraphs;
+	std::vector<bool> _corridor;
+	bool _useCorridor;
+	/// Leaves units and fire out of the move costs, while building the cluster graphs.
+	bool _terrainOnly;
+	std::vector<int> _path;
+	/// Gets everything that affects which tiles a unit can reach.
+	void getReachableState(BattleUnit *unit, std::vector<int> &state) const;
+	/// Calculates the cost of all reachable tiles.
+	void calculateReachable(BattleUnit *unit, int tuMax, std::vector<std::pair<int, int> > &tiles);
+	/// Gets the cluster (map block) a position belongs to.
+	int getCluster(Position pos) const;
+	/// Finds the moves out of a cluster.
+	void findClusterExits(ClusterCache &cache, int cluster);
+	/// Gets the moves from a tile to the neighbouring clusters.
+	const std::vector<ClusterEdge> &getClusterEdges(std::vector<ClusterCache> &graph, int tileIndex);
+	/// Tries to find a path between two far apart positions through the cluster graph.
+	bool hierarchicalPath(Position origin, Position target, BattleUnit *missileTarget, bool sneak = false, int maxTUCost = 1000);
+	/// Starts a new search, which makes all the nodes count as reset.
+	void newSearch();
 	/// Gets the node at certain position.
 	PathfindingNode *getNode(Position pos);
 	/// Determines whether a tile blocks a certain movementType.
@@ -56,7 +111,6 @@ private:
 	bool canFallDown(Tile *destinationTile) const;
 	/// Determines whether a unit can fall down from this tile.
 	bool canFallDown(Tile *destinationTile, int size) const;
-	std::vector<int> _path;
 public:
 	/// Determines whether the unit is going up a stairs.
 	bool isOnStairs(Position startPosition, Position endPosition) const;
@@ -95,6 +149,8 @@ public:
 	bool previewPath(bool bRemove = false);
 	/// Removes the path preview.
 	bool removePreview();
+	/// Drops the cached cluster moves around a tile whose terrain changed.
+	void terrainChanged(Position pos);
 	/// Sets _unit in order to abuse low-level pathfinding functions from outside the class.
 	void setUnit(BattleUnit *unit);
 	/// Gets all reachable tiles, based on cost.
@@ -23,7 +23,6 @@ namespace OpenXcom
 {
 
 class PathfindingOpenSet;
-struct OpenSetEntry;
 
 /**
  * A class that holds pathfinding info for a certain node on the map.
@@ -38,8 +37,10 @@ private:
 	int _prevDir;
 	/// Approximate cost to reach goal position.
 	int _tuGuess;
-	// Invasive field needed by PathfindingOpenSet
-	OpenSetEntry *_openentry;
+	/// The search this node was last used by.
+	unsigned int _searchId;
+	// Invasive fields needed by PathfindingOpenSet
+	int _heapIndex, _openCost;
 	friend class PathfindingOpenSet;
 public:
 	/// Creates a new PathfindingNode class.
@@ -50,6 +51,15 @@ public:
 	Position getPosition() const;
 	/// Resets the node.
 	void reset();
+	/// Resets the node if it was last used by an older search.
+	void startSearch(unsigned int searchId)
+	{
+		if (_searchId != searchId)
+		{
+			reset();
+			_searchId = searchId;
+		}
+	}
 	/// Is checked?
 	bool isChecked() const;
 	/// Marks the node as checked.
@@ -61,7 +71,7 @@ public:
 	/// Gets the previous walking direction.
 	int getPrevDir() const;
 	/// Is this node already in a PathfindingOpenSet?
-	bool inOpenSet() const { return (_openentry != 0); }
+	bool inOpenSet() const { return (_heapIndex >= 0); }
 	/// Gets the approximate cost to reach the target position.
 	int getTUGuess() const { return _tuGuess; }
 
@@ -24,29 +24,67 @@ namespace OpenXcom
 {
 
 /**
- * Cleans up all the entries still in set.
+ * Removes all the nodes from the set. The memory of the heap is kept for the next search.
  */
-PathfindingOpenSet::~PathfindingOpenSet()
+void PathfindingOpenSet::clear()
 {
-	while (!_queue.empty())
+	for (std::vector<PathfindingNode*>::iterator i = _heap.begin(); i != _heap.end(); ++i)
 	{
-		OpenSetEntry *entry = _queue.top();
-		_queue.pop();
-		delete entry;
+		(*i)->_heapIndex = -1;
 	}
+	_heap.clear();
 }
 
 /**
- * Keeps removing all discarded entries that have come to the top of the queue.
+ * Places a node at a position in the heap and lets it know where it is.
+ * @param node A pointer to the node.
+ * @param index Position in the heap.
  */
-void PathfindingOpenSet::removeDiscarded()
+void PathfindingOpenSet::place(PathfindingNode *node, int index)
 {
-	while (!_queue.empty() && !_queue.top()->_node)
+	_heap[index] = node;
+	node->_heapIndex = index;
+}
+
+/**
+ * Moves a node up the heap until its parent is cheaper.
+ * @param index Position of the node in the heap.
+ */
+void PathfindingOpenSet::siftUp(int index)
+{
+	PathfindingNode *node = _heap[index];
+	while (index > 0)
+	{
+		int parent = (index - 1) / 2;
+		if (_heap[parent]->_openCost <= node->_openCost)
+			break;
+		place(_heap[parent], index);
+		index = parent;
+	}
+	place(node, index);
+}
+
+/**
+ * Moves a node down the heap until its children are more expensive.
+ * @param index Position of the node in the heap.
+ */
+void PathfindingOpenSet::siftDown(int index)
+{
+	PathfindingNode *node = _heap[index];
+	int size = (int)_heap.size();
+	while (true)
 	{
-		OpenSetEntry *entry = _queue.top();
-		_queue.pop();
-		delete entry;
+		int child = index * 2 + 1;
+		if (child >= size)
+			break;
+		if (child + 1 < size && _heap[child + 1]->_openCost < _heap[child]->_openCost)
+			++child;
+		if (node->_openCost <= _heap[child]->_openCost)
+			break;
+		place(_heap[child], index);
+		index = child;
 	}
+	place(node, index);
 }
 
 /**
@@ -57,33 +95,33 @@ void PathfindingOpenSet::removeDiscarded()
 PathfindingNode *PathfindingOpenSet::pop()
 {
 	assert(!empty());
-	OpenSetEntry *entry = _queue.top();
-	PathfindingNode *nd = entry->_node;
-	_queue.pop();
-	delete entry;
-	nd->_openentry = 0;
-
-	// Discarded entries might be visible now.
-	removeDiscarded();
+	PathfindingNode *nd = _heap.front();
+	PathfindingNode *last = _heap.back();
+	_heap.pop_back();
+	if (!_heap.empty())
+	{
+		place(last, 0);
+		siftDown(0);
+	}
+	nd->_heapIndex = -1;
 	return nd;
 }
 
 /**
  * Places the node in the set.
- * If the node was already in the set, the previous entry is discarded.
+ * If the node was already in the set, it is moved to its new place.
  * It is the caller's responsibility to never re-add a node with a worse cost.
  * @param node A pointer to the node to add.
  */
 void PathfindingOpenSet::push(PathfindingNode *node)
 {
-	OpenSetEntry *entry = new OpenSetEntry;
-	entry->_node = node;
-	entry->_cost = node->getTUCost(false) + node->getTUGuess();
-	if (node->_openentry)
-		node->_openentry->_node = 0;
-	node->_openentry = entry;
-	_queue.push(entry);
+	node->_openCost = node->getTUCost(false) + node->getTUGuess();
+	if (node->_heapIndex < 0)
+	{
+		_heap.push_back(node);
+		node->_heapIndex = (int)_heap.size() - 1;
+	}
+	siftUp(node->_heapIndex);
 }
 
-
 }
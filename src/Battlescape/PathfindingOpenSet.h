@@ -17,57 +17,39 @@
  * You should have received a copy of the GNU General Public License
  * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
  */
-#include <queue>
+#include <vector>
 
 namespace OpenXcom
 {
 
 class PathfindingNode;
 
-struct OpenSetEntry
-{
-	int _cost;
-	PathfindingNode *_node;
-};
-
-/**
- * Helper class to compare entries through pointers.
- */
-class EntryCompare
-{
-public:
-	/**
-	 * Compares entries @a *a and @a *b.
-	 * @param a Pointer to first entry.
-	 * @param b Pointer to second entry.
-	 * @return True if entry @a *b must come before @a *a.
-	 */
-	bool operator()(OpenSetEntry *a, OpenSetEntry *b) const
-	{
-		return b->_cost < a->_cost;
-	}
-};
-
 /**
- * A class that holds references to the nodes to be examined in pathfinding.
+ * A binary heap of pathfinding nodes, ordered by their estimated total cost.
+ * Nodes keep track of their own place in the heap, so a node that is found
+ * again through a cheaper path is moved up instead of being added twice.
  */
 class PathfindingOpenSet
 {
 public:
-	/// Cleans up the set and frees allocated memory.
-	~PathfindingOpenSet();
+	/// Removes all the nodes from the set.
+	void clear();
 	/// Gets the next node to check.
 	PathfindingNode *pop();
-	/// Adds a node to the set.
+	/// Adds a node to the set, or updates its place.
 	void push(PathfindingNode *node);
 	/// Is the set empty?
-	bool empty() const { return _queue.empty(); }
+	bool empty() const { return _heap.empty(); }
 
 private:
-	std::priority_queue<OpenSetEntry*, std::vector<OpenSetEntry*>, EntryCompare> _queue;
-
-	/// Removes reachable discarded entries.
-	void removeDiscarded();
+	std::vector<PathfindingNode*> _heap;
+
+	/// Moves a node up the heap until its parent is cheaper.
+	void siftUp(int index);
+	/// Moves a node down the heap until its children are more expensive.
+	void siftDown(int index);
+	/// Places a node at a position in the heap.
+	void place(PathfindingNode *node, int index);
 };
 
 }
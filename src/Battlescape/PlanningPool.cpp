@@ -0,0 +1,95 @@
+/*
+ * Copyright 2010-2016 OpenXcom Developers.
+ *
+ * This file is part of OpenXcom.
+ *
+ * OpenXcom is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenXcom is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "PlanningPool.h"
+#include "Pathfinding.h"
+#include "TileEngine.h"
+#include "../Savegame/SavedBattleGame.h"
+
+namespace OpenXcom
+{
+
+/**
+ * Creates a pool of worker threads for the AI.
+ * The calling thread always helps out with the main Pathfinding,
+ * so no threads means the jobs run exactly as they would without a pool.
+ * @param save Pointer to the battle.
+ * @param threads Number of extra threads.
+ */
+PlanningPool::PlanningPool(SavedBattleGame *save, int threads) : _save(save), _pool(threads)
+{
+	_pathfinding.push_back(save->getPathfinding());
+	for (int i = 1; i < _pool.getThreadCount(); ++i)
+	{
+		_pathfinding.push_back(new Pathfinding(save));
+	}
+}
+
+/**
+ * Stops the worker threads and cleans up.
+ */
+PlanningPool::~PlanningPool()
+{
+	for (std::vector<Pathfinding*>::iterator i = _pathfinding.begin() + 1; i != _pathfinding.end(); ++i)
+	{
+		delete *i;
+	}
+}
+
+/**
+ * Gets the number of threads working on each job, including the calling thread.
+ * @return Number of threads.
+ */
+int PlanningPool::getThreadCount() const
+{
+	return _pool.getThreadCount();
+}
+
+/**
+ * Evaluates the candidates from first up to (not including) last, and
+ * returns once all of them are done. Jobs store their results by index,
+ * so the caller can go through them in order afterwards and get the
+ * same outcome no matter which thread evaluated what.
+ * @param job The job to run.
+ * @param first Index of the first candidate.
+ * @param last Index after the last candidate.
+ */
+void PlanningPool::run(Job *job, int first, int last)
+{
+	if (first >= last)
+		return;
+	// the jobs trace lines of fire, which needs the voxel summary in place
+	_save->getTileEngine()->updateVoxelSummary();
+	PathfindingJob pathfindingJob(job, _pathfinding);
+	_pool.run(&pathfindingJob, first, last);
+}
+
+/**
+ * Drops the cached map block moves of every worker around a tile
+ * whose terrain changed. Only called while no job is running.
+ * @param pos Position of the tile.
+ */
+void PlanningPool::terrainChanged(Position pos)
+{
+	for (std::vector<Pathfinding*>::iterator i = _pathfinding.begin() + 1; i != _pathfinding.end(); ++i)
+	{
+		(*i)->terrainChanged(pos);
+	}
+}
+
+}
@@ -0,0 +1,84 @@
+#pragma once
+/*
+ * Copyright 2010-2016 OpenXcom Developers.
+ *
+ * This file is part of OpenXcom.
+ *
+ * OpenXcom is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenXcom is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <vector>
+#include "Position.h"
+#include "../Engine/WorkerPool.h"
+
+namespace OpenXcom
+{
+
+class SavedBattleGame;
+class Pathfinding;
+
+/**
+ * Runs AI jobs on a WorkerPool to evaluate many candidate
+ * moves at once. Every worker has its own Pathfinding,
+ * while the rest of the battle must only be read by the jobs.
+ */
+class PlanningPool
+{
+public:
+	/// A piece of work split into independent candidates.
+	class Job
+	{
+	public:
+		virtual ~Job() {}
+		/// Evaluates a single candidate. Must not change the battle or use the RNG.
+		virtual void run(Pathfinding *pathfinding, int index) = 0;
+	};
+	/// A job that calls a member function of an object for every candidate.
+	template <typename T>
+	class MemberJob : public Job
+	{
+	private:
+		T *_object;
+		void (T::*_function)(Pathfinding*, int);
+	public:
+		MemberJob(T *object, void (T::*function)(Pathfinding*, int)) : _object(object), _function(function) {}
+		void run(Pathfinding *pathfinding, int index) { (_object->*_function)(pathfinding, index); }
+	};
+private:
+	/// Hands each candidate to the pathfinding of the worker evaluating it.
+	class PathfindingJob : public WorkerPool::Job
+	{
+	private:
+		PlanningPool::Job *_job;
+		const std::vector<Pathfinding*> &_pathfinding;
+	public:
+		PathfindingJob(PlanningPool::Job *job, const std::vector<Pathfinding*> &pathfinding) : _job(job), _pathfinding(pathfinding) {}
+		void run(int index, int worker) { _job->run(_pathfinding[worker], index); }
+	};
+	SavedBattleGame *_save;
+	WorkerPool _pool;
+	std::vector<Pathfinding*> _pathfinding;
+public:
+	/// Creates a pool of worker threads.
+	PlanningPool(SavedBattleGame *save, int threads);
+	/// Stops the worker threads.
+	~PlanningPool();
+	/// Gets the number of threads working on each job.
+	int getThreadCount() const;
+	/// Evaluates a range of candidates of a job.
+	void run(Job *job, int first, int last);
+	/// Drops the pathfinding caches around a tile whose terrain changed.
+	void terrainChanged(Position pos);
+};
+
+}
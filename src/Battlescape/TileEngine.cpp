@@ -19,6 +19,8 @@
 #include <assert.h>
 #include <climits>
 #include <set>
+#include <algorithm>
+#include <iterator>
 #include "TileEngine.h"
 #include <SDL.h>
 #include "AIModule.h"
@@ -53,8 +55,28 @@ const int TileEngine::heightFromCenter[11] = {0,-2,+2,-4,+4,-6,+6,-8,+8,-12,+12}
  * @param save Pointer to SavedBattleGame object.
  * @param voxelData List of voxel data.
  */
-TileEngine::TileEngine(SavedBattleGame *save, std::vector<Uint16> *voxelData) : _save(save), _voxelData(voxelData), _personalLighting(true)
+TileEngine::TileEngine(SavedBattleGame *save, std::vector<Uint16> *voxelData) : _save(save), _voxelData(voxelData), _lightFalloffSize(0), _lightVersion(0), _fovGeneration(0), _sightBlockageVersion(-1), _personalLighting(true), _explosionStepLength(0), _explosionGeneration(0), _explosionBatch(0), _voxelSummaryValid(false)
 {
+	for (int layer = 0; layer < LIGHT_LAYERS; ++layer)
+	{
+		_lightValid[layer] = false;
+	}
+	// sort the LOFTs into empty, full and mixed ones
+	_loftSummary.resize(_voxelData->size() / 16, VOXELS_MIXED);
+	for (size_t loft = 0; loft < _loftSummary.size(); ++loft)
+	{
+		bool empty = true, full = true;
+		for (int y = 0; y < 16; ++y)
+		{
+			Uint16 row = _voxelData->at(loft * 16 + y);
+			empty = empty && row == 0;
+			full = full && row == 0xFFFF;
+		}
+		if (empty)
+			_loftSummary[loft] = VOXELS_EMPTY;
+		else if (full)
+			_loftSummary[loft] = 0;
+	}
 }
 
 /**
@@ -77,6 +99,7 @@ void TileEngine::calculateSunShading()
 		_save->getTiles()[i]->resetLight(layer);
 		calculateSunShading(_save->getTiles()[i]);
 	}
+	++_lightVersion;
 }
 
 /**
@@ -117,43 +140,38 @@ void TileEngine::calculateTerrainLighting()
 	const int layer = 1; // Static lighting layer.
 	const int fireLightPower = 15; // amount of light a fire generates
 
-	// reset all light to 0 first
-	for (int i = 0; i < _save->getMapSizeXYZ(); ++i)
-	{
-		_save->getTiles()[i]->resetLight(layer);
-	}
-
-	// add lighting of terrain
+	std::vector<LightSource> sources;
 	for (int i = 0; i < _save->getMapSizeXYZ(); ++i)
 	{
+		Tile *tile = _save->getTiles()[i];
 		// only floors and objects can light up
-		if (_save->getTiles()[i]->getMapData(O_FLOOR)
-			&& _save->getTiles()[i]->getMapData(O_FLOOR)->getLightSource())
+		if (tile->getMapData(O_FLOOR)
+			&& tile->getMapData(O_FLOOR)->getLightSource())
 		{
-			addLight(_save->getTiles()[i]->getPosition(), _save->getTiles()[i]->getMapData(O_FLOOR)->getLightSource(), layer);
+			sources.push_back(LightSource(tile->getPosition(), tile->getMapData(O_FLOOR)->getLightSource()));
 		}
-		if (_save->getTiles()[i]->getMapData(O_OBJECT)
-			&& _save->getTiles()[i]->getMapData(O_OBJECT)->getLightSource())
+		if (tile->getMapData(O_OBJECT)
+			&& tile->getMapData(O_OBJECT)->getLightSource())
 		{
-			addLight(_save->getTiles()[i]->getPosition(), _save->getTiles()[i]->getMapData(O_OBJECT)->getLightSource(), layer);
+			sources.push_back(LightSource(tile->getPosition(), tile->getMapData(O_OBJECT)->getLightSource()));
 		}
 
 		// fires
-		if (_save->getTiles()[i]->getFire())
+		if (tile->getFire())
 		{
-			addLight(_save->getTiles()[i]->getPosition(), fireLightPower, layer);
+			sources.push_back(LightSource(tile->getPosition(), fireLightPower));
 		}
 
-		for (std::vector<BattleItem*>::iterator it = _save->getTiles()[i]->getInventory()->begin(); it != _save->getTiles()[i]->getInventory()->end(); ++it)
+		for (std::vector<BattleItem*>::iterator it = tile->getInventory()->begin(); it != tile->getInventory()->end(); ++it)
 		{
 			if ((*it)->getRules()->getBattleType() == BT_FLARE)
 			{
-				addLight(_save->getTiles()[i]->getPosition(), (*it)->getRules()->getPower(), layer);
+				sources.push_back(LightSource(tile->getPosition(), (*it)->getRules()->getPower()));
 			}
 		}
-
 	}
 
+	updateLightLayer(sources, layer);
 }
 
 /**
@@ -165,58 +183,168 @@ void TileEngine::calculateUnitLighting()
 	const int personalLightPower = 15; // amount of light a unit generates
 	const int fireLightPower = 15; // amount of light a fire generates
 
-	// reset all light to 0 first
-	for (int i = 0; i < _save->getMapSizeXYZ(); ++i)
-	{
-		_save->getTiles()[i]->resetLight(layer);
-	}
-
+	std::vector<LightSource> sources;
 	for (std::vector<BattleUnit*>::iterator i = _save->getUnits()->begin(); i != _save->getUnits()->end(); ++i)
 	{
 		// add lighting of soldiers
 		if (_personalLighting && (*i)->getFaction() == FACTION_PLAYER && !(*i)->isOut())
 		{
-			addLight((*i)->getPosition(), personalLightPower, layer);
+			sources.push_back(LightSource((*i)->getPosition(), personalLightPower));
 		}
 		// add lighting of units on fire
 		if ((*i)->getFire())
 		{
-			addLight((*i)->getPosition(), fireLightPower, layer);
+			sources.push_back(LightSource((*i)->getPosition(), fireLightPower));
+		}
+	}
+
+	updateLightLayer(sources, layer);
+}
+
+/**
+ * Orders light sources by position, then power.
+ * @param other Light source to compare with.
+ * @return True if this light source comes first.
+ */
+bool TileEngine::LightSource::operator<(const LightSource &other) const
+{
+	if (center.z != other.center.z)
+		return center.z < other.center.z;
+	if (center.y != other.center.y)
+		return center.y < other.center.y;
+	if (center.x != other.center.x)
+		return center.x < other.center.x;
+	return power < other.power;
+}
+
+/**
+ * Gets how much light is lost over a horizontal distance, from a table
+ * that is grown as needed so no square roots are taken while lighting.
+ * @param dx Distance along the X axis.
+ * @param dy Distance along the Y axis.
+ * @return Light lost.
+ */
+int TileEngine::getLightFalloff(int dx, int dy)
+{
+	if (dx >= _lightFalloffSize || dy >= _lightFalloffSize)
+	{
+		_lightFalloffSize = std::max(dx, dy) + 1;
+		_lightFalloff.resize(_lightFalloffSize * _lightFalloffSize);
+		for (int x = 0; x < _lightFalloffSize; ++x)
+		{
+			for (int y = 0; y < _lightFalloffSize; ++y)
+			{
+				_lightFalloff[x * _lightFalloffSize + y] = (int)Round(sqrt(float(x*x + y*y)));
+			}
 		}
 	}
+	return _lightFalloff[dx * _lightFalloffSize + dy];
 }
 
 /**
  * Adds circular light pattern starting from center and losing power with distance travelled.
- * @param center Center.
- * @param power Power.
+ * Only the tiles inside the given region are lit.
+ * @param source Light source.
  * @param layer Light is separated in 3 layers: Ambient, Static and Dynamic.
+ * @param x1 Left edge of the region.
+ * @param y1 Top edge of the region.
+ * @param x2 Right edge of the region (inclusive).
+ * @param y2 Bottom edge of the region (inclusive).
  */
-void TileEngine::addLight(Position center, int power, int layer)
+void TileEngine::addLight(const LightSource &source, int layer, int x1, int y1, int x2, int y2)
 {
-	// only loop through the positive quadrant.
-	for (int x = 0; x <= power; ++x)
+	x1 = std::max(x1, source.center.x - source.power);
+	y1 = std::max(y1, source.center.y - source.power);
+	x2 = std::min(x2, source.center.x + source.power);
+	y2 = std::min(y2, source.center.y + source.power);
+	getLightFalloff(source.power, source.power);
+	for (int x = x1; x <= x2; ++x)
 	{
-		for (int y = 0; y <= power; ++y)
+		for (int y = y1; y <= y2; ++y)
 		{
+			int power = source.power - getLightFalloff(abs(x - source.center.x), abs(y - source.center.y));
+			if (power <= 0)
+				continue;
 			for (int z = 0; z < _save->getMapSizeZ(); z++)
 			{
-				int distance = (int)Round(sqrt(float(x*x + y*y)));
+				_save->getTile(Position(x, y, z))->addLight(power, layer);
+			}
+		}
+	}
+}
 
-				if (_save->getTile(Position(center.x + x,center.y + y, z)))
-					_save->getTile(Position(center.x + x,center.y + y, z))->addLight(power - distance, layer);
+/**
+ * Replaces the light sources of a layer and relights the map.
+ * Lights spread through every level regardless of terrain, so only
+ * the areas reached by sources that appeared or disappeared since
+ * the last update need to be reset and relit from the sources overlapping them.
+ * @param sources New light sources of the layer.
+ * @param layer Light is separated in 3 layers: Ambient, Static and Dynamic.
+ */
+void TileEngine::updateLightLayer(std::vector<LightSource> &sources, int layer)
+{
+	std::sort(sources.begin(), sources.end());
 
-				if (_save->getTile(Position(center.x - x,center.y - y, z)))
-					_save->getTile(Position(center.x - x,center.y - y, z))->addLight(power - distance, layer);
+	std::vector<LightSource> changed;
+	if (_lightValid[layer])
+	{
+		std::set_symmetric_difference(_lightSources[layer].begin(), _lightSources[layer].end(), sources.begin(), sources.end(), std::back_inserter(changed));
+		if (changed.empty())
+		{
+			_lightSources[layer].swap(sources);
+			return;
+		}
+	}
 
-				if (_save->getTile(Position(center.x - x,center.y + y, z)))
-					_save->getTile(Position(center.x - x,center.y + y, z))->addLight(power - distance, layer);
+	const int maxX = _save->getMapSizeX() - 1;
+	const int maxY = _save->getMapSizeY() - 1;
+	std::vector<SDL_Rect> regions;
+	if (!_lightValid[layer] || changed.size() > (size_t)MAX_LIGHT_CHANGES)
+	{
+		SDL_Rect all = { 0, 0, (Uint16)(maxX + 1), (Uint16)(maxY + 1) };
+		regions.push_back(all);
+	}
+	else
+	{
+		for (std::vector<LightSource>::const_iterator i = changed.begin(); i != changed.end(); ++i)
+		{
+			int x1 = std::max(0, i->center.x - i->power);
+			int y1 = std::max(0, i->center.y - i->power);
+			int x2 = std::min(maxX, i->center.x + i->power);
+			int y2 = std::min(maxY, i->center.y + i->power);
+			if (x1 > x2 || y1 > y2)
+				continue;
+			SDL_Rect region = { (Sint16)x1, (Sint16)y1, (Uint16)(x2 - x1 + 1), (Uint16)(y2 - y1 + 1) };
+			regions.push_back(region);
+		}
+	}
 
-				if (_save->getTile(Position(center.x + x,center.y - y, z)))
-					_save->getTile(Position(center.x + x,center.y - y, z))->addLight(power - distance, layer);
+	for (std::vector<SDL_Rect>::const_iterator r = regions.begin(); r != regions.end(); ++r)
+	{
+		const int x1 = r->x, y1 = r->y, x2 = r->x + r->w - 1, y2 = r->y + r->h - 1;
+		for (int z = 0; z < _save->getMapSizeZ(); ++z)
+		{
+			for (int y = y1; y <= y2; ++y)
+			{
+				for (int x = x1; x <= x2; ++x)
+				{
+					_save->getTile(Position(x, y, z))->resetLight(layer);
+				}
+			}
+		}
+		for (std::vector<LightSource>::const_iterator i = sources.begin(); i != sources.end(); ++i)
+		{
+			if (i->center.x + i->power >= x1 && i->center.x - i->power <= x2 &&
+				i->center.y + i->power >= y1 && i->center.y - i->power <= y2)
+			{
+				addLight(*i, layer, x1, y1, x2, y2);
 			}
 		}
 	}
+
+	_lightSources[layer].swap(sources);
+	_lightValid[layer] = true;
+	++_lightVersion;
 }
 
 /**
@@ -259,7 +387,48 @@ bool TileEngine::calculateFOV(BattleUnit *unit)
 			++pos.z;
 		}
 	}
-	for (int x = 0; x <= MAX_VIEW_DISTANCE; ++x)
+
+	// tiles stay discovered once seen, so there is no need to sweep them again
+	// unless the unit has moved, turned, or the terrain has changed since
+	bool sweepTiles = false;
+	if (unit->getFaction() == FACTION_PLAYER)
+	{
+		FovSweep &sweep = _fovSweeps[unit->getId()];
+		if (!(sweep.center == center && sweep.eyes == pos && sweep.direction == direction && sweep.terrainVersion == _save->getTerrainVersion()))
+		{
+			sweep.center = center;
+			sweep.eyes = pos;
+			sweep.direction = direction;
+			sweep.terrainVersion = _save->getTerrainVersion();
+			sweepTiles = true;
+			if ((int)_fovMarked.size() != _save->getMapSizeXYZ())
+			{
+				_fovMarked.assign(_save->getMapSizeXYZ(), 0);
+			}
+			++_fovGeneration;
+		}
+	}
+
+	// the units in view only change when something moves, burns or changes
+	// the terrain or the light, so the ones seen last time can be used again
+	FovUnits &seen = _fovUnits[unit->getId()];
+	bool findUnits = !(seen.center == center && seen.eyes == pos && seen.direction == direction && seen.faction == unit->getFaction() &&
+		seen.terrainVersion == _save->getTerrainVersion() && seen.unitsVersion == _save->getUnitsVersion() &&
+		seen.fireVersion == _save->getFireVersion() && seen.lightVersion == _lightVersion);
+	if (findUnits)
+	{
+		seen.center = center;
+		seen.eyes = pos;
+		seen.direction = direction;
+		seen.faction = unit->getFaction();
+		seen.terrainVersion = _save->getTerrainVersion();
+		seen.unitsVersion = _save->getUnitsVersion();
+		seen.fireVersion = _save->getFireVersion();
+		seen.lightVersion = _lightVersion;
+		seen.units.clear();
+	}
+
+	for (int x = 0; x <= MAX_VIEW_DISTANCE && (findUnits || sweepTiles); ++x)
 	{
 		if (direction%2)
 		{
@@ -284,27 +453,12 @@ bool TileEngine::calculateFOV(BattleUnit *unit)
 					if (_save->getTile(test))
 					{
 						BattleUnit *visibleUnit = _save->getTile(test)->getUnit();
-						if (visibleUnit && !visibleUnit->isOut() && visible(unit, _save->getTile(test)))
+						if (findUnits && visibleUnit && !visibleUnit->isOut() && visible(unit, _save->getTile(test)))
 						{
-							if (unit->getFaction() == FACTION_PLAYER)
-							{
-								visibleUnit->getTile()->setVisible(+1);
-								visibleUnit->setVisible(true);
-							}
-							if ((visibleUnit->getFaction() == FACTION_HOSTILE && unit->getFaction() == FACTION_PLAYER)
-								|| (visibleUnit->getFaction() != FACTION_HOSTILE && unit->getFaction() == FACTION_HOSTILE))
-							{
-								unit->addToVisibleUnits(visibleUnit);
-								unit->addToVisibleTiles(visibleUnit->getTile());
-
-								if (unit->getFaction() == FACTION_HOSTILE && visibleUnit->getFaction() != FACTION_HOSTILE)
-								{
-									visibleUnit->setTurnsSinceSpotted(0);
-								}
-							}
+							seen.units.push_back(visibleUnit);
 						}
 
-						if (unit->getFaction() == FACTION_PLAYER)
+						if (sweepTiles)
 						{
 							// this sets tiles to discovered if they are in LOS - tile visibility is not calculated in voxelspace but in tilespace
 							// large units have "4 pair of eyes"
@@ -315,12 +469,17 @@ bool TileEngine::calculateFOV(BattleUnit *unit)
 								{
 									Position poso = pos + Position(xo,yo,0);
 									_trajectory.clear();
-									int tst = calculateLine(poso, test, true, &_trajectory, unit, false);
+									int tst = calculateSightLine(poso, test, &_trajectory);
 									size_t tsize = _trajectory.size();
 									if (tst>127) --tsize; //last tile is blocked thus must be cropped
 									for (size_t i = 0; i < tsize; i++)
 									{
 										Position posi = _trajectory.at(i);
+										// lines to neighbouring targets mostly overlap, only mark each tile once per sweep
+										int index = _save->getTileIndex(posi);
+										if (_fovMarked[index] == _fovGeneration)
+											continue;
+										_fovMarked[index] = _fovGeneration;
 										//mark every tile of line as visible (as in original)
 										//this is needed because of bresenham narrow stroke.
 										_save->getTile(posi)->setVisible(+1);
@@ -341,6 +500,31 @@ bool TileEngine::calculateFOV(BattleUnit *unit)
 		}
 	}
 
+	for (std::vector<BattleUnit*>::const_iterator i = seen.units.begin(); i != seen.units.end(); ++i)
+	{
+		BattleUnit *visibleUnit = *i;
+		if (visibleUnit->isOut())
+		{
+			continue;
+		}
+		if (unit->getFaction() == FACTION_PLAYER)
+		{
+			visibleUnit->getTile()->setVisible(+1);
+			visibleUnit->setVisible(true);
+		}
+		if ((visibleUnit->getFaction() == FACTION_HOSTILE && unit->getFaction() == FACTION_PLAYER)
+			|| (visibleUnit->getFaction() != FACTION_HOSTILE && unit->getFaction() == FACTION_HOSTILE))
+		{
+			unit->addToVisibleUnits(visibleUnit);
+			unit->addToVisibleTiles(visibleUnit->getTile());
+
+			if (unit->getFaction() == FACTION_HOSTILE && visibleUnit->getFaction() != FACTION_HOSTILE)
+			{
+				visibleUnit->setTurnsSinceSpotted(0);
+			}
+		}
+	}
+
 	// we only react when there are at least the same amount of visible units as before AND the checksum is different
 	// this way we stop if there are the same amount of visible units, but a different unit is seen
 	// or we stop if there are more visible units seen
@@ -1058,10 +1242,23 @@ BattleUnit *TileEngine::hit(Position center, int power, ItemDamageType type, Bat
 		{
 			_save->getModuleMap()[(center.x/16)/10][(center.y/16)/10].second--;
 		}
+		MapData *before[4];
+		for (int i = 0; i < 4; ++i)
+		{
+			before[i] = tile->getMapData(i);
+		}
 		if (tile->damage(part, rndPower, _save->getObjectiveType()))
 		{
 			_save->addDestroyedObjective();
 		}
+		for (int i = 0; i < 4; ++i)
+		{
+			if (tile->getMapData(i) != before[i])
+			{
+				_save->terrainChanged(tile);
+				break;
+			}
+		}
 	}
 	else if (part == V_UNIT)
 	{
@@ -1147,17 +1344,30 @@ void TileEngine::explode(Position center, int power, ItemDamageType type, int ma
 	double centerZ = center.z / 24 + 0.5;
 	double centerX = center.x / 16 + 0.5;
 	double centerY = center.y / 16 + 0.5;
+	Position centerTile = center / Position(16, 16, 24);
 	int hitSide = 0;
 	int diagonalWall = 0;
 	int power_;
-	std::set<Tile*> tilesAffected;
-	std::pair<std::set<Tile*>::iterator,bool> ret;
 
 	if (type == DT_IN)
 	{
 		power /= 2;
 	}
 
+	// every tile is only affected once, so stamp the ones we had already
+	if ((int)_explosionVisited.size() != _save->getMapSizeXYZ() || _explosionGeneration == INT_MAX)
+	{
+		_explosionVisited.assign(_save->getMapSizeXYZ(), 0);
+		_explosionGeneration = 0;
+	}
+	++_explosionGeneration;
+	_explosionTiles.clear();
+
+	// power drops by at least 10 per tile, and no ray stays on the map longer than its diagonal
+	int length = std::min(std::max(maxRadius, 0), std::max(power, 0) / 10) + 1;
+	length = std::min(length, _save->getMapSizeX() + _save->getMapSizeY() + _save->getMapSizeZ() + 1);
+	buildExplosionSteps(length);
+
 	int exHeight = std::max(0, std::min(3, Options::battleExplosionHeight));
 	int vertdec = 1000; //default flat explosion
 	int dmgRng = type == DT_HE ? Mod::EXPLOSIVE_DAMAGE_RANGE : Mod::DAMAGE_RANGE;
@@ -1185,20 +1395,18 @@ void TileEngine::explode(Position center, int power, ItemDamageType type, int ma
 			hitSide = (center.x % 16 + center.y % 16 - 15) > 0 ? 1 : -1;
 	}
 
-	for (int fi = -90; fi <= 90; fi += 5)
+	for (int fi = 0; fi < EXPLOSION_RAYS_FI; ++fi)
 	{
 		// raytrace every 3 degrees makes sure we cover all tiles in a circle.
-		for (int te = 0; te <= 360; te += 3)
+		for (int te = 0; te < EXPLOSION_RAYS_TE; ++te)
 		{
-			double cos_te = cos(te * M_PI / 180.0);
-			double sin_te = sin(te * M_PI / 180.0);
-			double sin_fi = sin(fi * M_PI / 180.0);
-			double cos_fi = cos(fi * M_PI / 180.0);
+			const Position *steps = &_explosionSteps[(fi * EXPLOSION_RAYS_TE + te) * _explosionStepLength];
+			int angle = te * 3;
 
 			origin = _save->getTile(Position(centerX, centerY, centerZ));
 			dest = origin;
-			double l = 0;
-			int tileX, tileY, tileZ;
+			int l = 0;
+			int tileZ;
 			power_ = power;
 			while (power_ > 0 && l <= maxRadius)
 			{
@@ -1210,9 +1418,11 @@ void TileEngine::explode(Position center, int power, ItemDamageType type, int ma
 						dest->setExplosive(power_, 0);
 					}
 
-					ret = tilesAffected.insert(dest); // check if we had this tile already
-					if (ret.second)
+					int index = _save->getTileIndex(dest->getPosition());
+					if (_explosionVisited[index] != _explosionGeneration) // check if we had this tile already
 					{
+						_explosionVisited[index] = _explosionGeneration;
+						_explosionTiles.push_back(index);
 						int min = power_ * (100 - dmgRng) / 100;
 						int max = power_ * (100 + dmgRng) / 100;
 						BattleUnit *bu = dest->getUnit();
@@ -1292,6 +1502,7 @@ void TileEngine::explode(Position center, int power, ItemDamageType type, int ma
 							{
 								dest->setFire(0);
 								dest->setSmoke(RNG::generate(7, 15));
+								_save->fireChanged();
 							}
 							break;
 
@@ -1302,6 +1513,7 @@ void TileEngine::explode(Position center, int power, ItemDamageType type, int ma
 								{
 									dest->setFire(dest->getFuel() + 1);
 									dest->setSmoke(std::max(1, std::min(15 - (dest->getFlammability() / 10), 12)));
+									_save->fireChanged();
 								}
 								if (bu)
 								{
@@ -1335,14 +1547,14 @@ void TileEngine::explode(Position center, int power, ItemDamageType type, int ma
 					}
 				}
 
-				l += 1.0;
+				++l;
+				if (l >= _explosionStepLength) break; // power is spent, or we left the map
 
-				tileX = int(floor(centerX + l * sin_te * cos_fi));
-				tileY = int(floor(centerY + l * cos_te * cos_fi));
-				tileZ = int(floor(centerZ + l * sin_fi));
+				Position tile = centerTile + steps[l];
+				tileZ = tile.z;
 
 				origin = dest;
-				dest = _save->getTile(Position(tileX, tileY, tileZ));
+				dest = _save->getTile(tile);
 
 				if (!dest) break; // out of map!
 
@@ -1357,8 +1569,8 @@ void TileEngine::explode(Position center, int power, ItemDamageType type, int ma
 					Pathfinding::vectorToDirection(origin->getPosition() - dest->getPosition(), dir);
 					if (dir != -1 && dir %2) power_ -= 5; // diagonal movement costs an extra 50% for fire.
 				}
-				if (l > 0.5) {
-					if ( l > 1.5)
+				if (l > 0) {
+					if (l > 1)
 					{
 						power_ -= verticalBlockage(origin, dest, type, false) * 2;
 						power_ -= horizontalBlockage(origin, dest, type, false) * 2;
@@ -1368,16 +1580,16 @@ void TileEngine::explode(Position center, int power, ItemDamageType type, int ma
 						bool skipObject = diagonalWall == 0;
 						if (diagonalWall == Pathfinding::BIGWALLNESW) // --
 						{
-							if (hitSide<0 && te >= 135 && te < 315)
+							if (hitSide<0 && angle >= 135 && angle < 315)
 								skipObject = true;
-							if (hitSide>0 && ( te < 135 || te > 315))
+							if (hitSide>0 && ( angle < 135 || angle > 315))
 								skipObject = true;
 						}
 						if (diagonalWall == Pathfinding::BIGWALLNWSE) // |
 						{
-							if (hitSide>0 && te >= 45 && te < 225)
+							if (hitSide>0 && angle >= 45 && angle < 225)
 								skipObject = true;
-							if (hitSide<0 && ( te < 45 || te > 225))
+							if (hitSide<0 && ( angle < 45 || angle > 225))
 								skipObject = true;
 						}
 						power_ -= verticalBlockage(origin, dest, type, skipObject) * 2;
@@ -1392,22 +1604,101 @@ void TileEngine::explode(Position center, int power, ItemDamageType type, int ma
 
 	if (type == DT_HE)
 	{
-		for (std::set<Tile*>::iterator i = tilesAffected.begin(); i != tilesAffected.end(); ++i)
+		// go through the map in order, so the outcome doesn't depend on the ray order
+		std::sort(_explosionTiles.begin(), _explosionTiles.end());
+		for (std::vector<int>::iterator i = _explosionTiles.begin(); i != _explosionTiles.end(); ++i)
 		{
-			if (detonate(*i))
+			Tile *tile = _save->getTiles()[*i];
+			if (detonate(tile))
 			{
 				_save->addDestroyedObjective();
 			}
-			applyGravity(*i);
-			Tile *j = _save->getTile((*i)->getPosition() + Position(0,0,1));
+			applyGravity(tile);
+			Tile *j = _save->getTile(tile->getPosition() + Position(0,0,1));
 			if (j)
 				applyGravity(j);
 		}
 	}
 
+	if (_explosionBatch > 0)
+	{
+		_explosionBatchCenters.push_back(centerTile);
+	}
+	else
+	{
+		finishExplosions(std::vector<Position>(1, centerTile));
+	}
+}
+
+/**
+ * Builds the tile offsets every explosion ray passes through,
+ * so explosions don't have to redo the trigonometry for every ray.
+ * The offsets are relative to the center of the exploding tile.
+ * @param length Number of steps needed along each ray.
+ */
+void TileEngine::buildExplosionSteps(int length)
+{
+	if (length <= _explosionStepLength)
+		return;
+
+	_explosionSteps.resize(EXPLOSION_RAYS_FI * EXPLOSION_RAYS_TE * length);
+	for (int fi = 0; fi < EXPLOSION_RAYS_FI; ++fi)
+	{
+		double sin_fi = sin((fi * 5 - 90) * M_PI / 180.0);
+		double cos_fi = cos((fi * 5 - 90) * M_PI / 180.0);
+		for (int te = 0; te < EXPLOSION_RAYS_TE; ++te)
+		{
+			double cos_te = cos(te * 3 * M_PI / 180.0);
+			double sin_te = sin(te * 3 * M_PI / 180.0);
+			Position *steps = &_explosionSteps[(fi * EXPLOSION_RAYS_TE + te) * length];
+			for (int l = 0; l < length; ++l)
+			{
+				steps[l].x = int(floor(0.5 + l * sin_te * cos_fi));
+				steps[l].y = int(floor(0.5 + l * cos_te * cos_fi));
+				steps[l].z = int(floor(0.5 + l * sin_fi));
+			}
+		}
+	}
+	_explosionStepLength = length;
+}
+
+/**
+ * Updates lighting and vision after the terrain was blown up.
+ * @param centers Tiles where explosions went off.
+ */
+void TileEngine::finishExplosions(const std::vector<Position> &centers)
+{
 	calculateSunShading(); // roofs could have been destroyed
 	calculateTerrainLighting(); // fires could have been started
-	calculateFOV(center / Position(16,16,24));
+	for (std::vector<Position>::const_iterator i = centers.begin(); i != centers.end(); ++i)
+	{
+		if (std::find(centers.begin(), i, *i) == i)
+		{
+			calculateFOV(*i);
+		}
+	}
+}
+
+/**
+ * Starts a batch of explosions, such as a chain of exploding terrain.
+ * Lighting and vision are only updated once the batch ends.
+ */
+void TileEngine::beginExplosionBatch()
+{
+	++_explosionBatch;
+}
+
+/**
+ * Ends a batch of explosions and updates lighting and vision for all of them.
+ */
+void TileEngine::endExplosionBatch()
+{
+	if (_explosionBatch > 0 && --_explosionBatch == 0 && !_explosionBatchCenters.empty())
+	{
+		std::vector<Position> centers;
+		centers.swap(_explosionBatchCenters);
+		finishExplosions(centers);
+	}
 }
 
 /**
@@ -1492,6 +1783,7 @@ bool TileEngine::detonate(Tile* tile)
 				currentpart2 = currentpart;
 			if (tiles[i]->destroy(currentpart, _save->getObjectiveType()))
 				objective = true;
+			_save->terrainChanged(tiles[i]);
 			currentpart =  currentpart2;
 			if (tiles[i]->getMapData(currentpart)) // take new values
 			{
@@ -1506,6 +1798,7 @@ bool TileEngine::detonate(Tile* tile)
 			{
 				tiles[i]->setFire(fuel);
 				tiles[i]->setSmoke(std::max(1, std::min(15 - (fireProof / 10), 12)));
+				_save->fireChanged();
 			}
 		}
 		// add some smoke if tile was destroyed and not set on fire
@@ -2017,6 +2310,10 @@ int TileEngine::unitOpensDoor(BattleUnit *unit, bool rClick, int dir)
 					if (door != -1)
 					{
 						part = i->second;
+						if (door == 0 || door == 1)
+						{
+							_save->terrainChanged(tile);
+						}
 						if (door == 1)
 						{
 							checkAdjacentDoors(unit->getPosition() + Position(x,y,z) + i->first, i->second);
@@ -2082,6 +2379,7 @@ void TileEngine::checkAdjacentDoors(const Position& pos, int part)
 		if (tile && tile->getMapData(part) && tile->getMapData(part)->isUFODoor())
 		{
 			tile->openDoor(part);
+			_save->terrainChanged(tile);
 		}
 		else break;
 	}
@@ -2092,6 +2390,7 @@ void TileEngine::checkAdjacentDoors(const Position& pos, int part)
 		if (tile && tile->getMapData(part) && tile->getMapData(part)->isUFODoor())
 		{
 			tile->openDoor(part);
+			_save->terrainChanged(tile);
 		}
 		else break;
 	}
@@ -2120,7 +2419,11 @@ int TileEngine::closeUfoDoors()
 				continue;
 			}
 		}
-		doorsclosed += _save->getTiles()[i]->closeUfoDoor();
+		if (_save->getTiles()[i]->closeUfoDoor())
+		{
+			_save->terrainChanged(_save->getTiles()[i]);
+			++doorsclosed;
+		}
 	}
 
 	return doorsclosed;
@@ -2190,6 +2493,13 @@ int TileEngine::calculateLine(Position origin, Position target, bool storeTrajec
 	y = y0;
 	z = z0;
 
+	//voxels of the last tile the line passes through freely
+	Position passMin(1, 1, 1), passMax(0, 0, 0);
+	if (doVoxelCheck)
+	{
+		updateVoxelSummary();
+	}
+
 	//step through longest delta (which we have swapped to x)
 	for (x = x0; x != (x1+step_x); x += step_x)
 	{
@@ -2207,7 +2517,7 @@ int TileEngine::calculateLine(Position origin, Position target, bool storeTrajec
 		//passes through this point?
 		if (doVoxelCheck)
 		{
-			result = voxelCheck(Position(cx, cy, cz), excludeUnit, false, onlyVisible, excludeAllBut);
+			result = lineVoxelCheck(Position(cx, cy, cz), excludeUnit, onlyVisible, excludeAllBut, passMin, passMax);
 			if (result != V_EMPTY)
 			{
 				if (trajectory)
@@ -2255,7 +2565,7 @@ int TileEngine::calculateLine(Position origin, Position target, bool storeTrajec
 				cx = x;	cz = z; cy = y;
 				if (swap_xz) std::swap(cx, cz);
 				if (swap_xy) std::swap(cx, cy);
-				result = voxelCheck(Position(cx, cy, cz), excludeUnit, false, onlyVisible, excludeAllBut);
+				result = lineVoxelCheck(Position(cx, cy, cz), excludeUnit, onlyVisible, excludeAllBut, passMin, passMax);
 				if (result != V_EMPTY)
 				{
 					if (trajectory != 0)
@@ -2279,7 +2589,7 @@ int TileEngine::calculateLine(Position origin, Position target, bool storeTrajec
 				cx = x;	cz = z; cy = y;
 				if (swap_xz) std::swap(cx, cz);
 				if (swap_xy) std::swap(cx, cy);
-				result = voxelCheck(Position(cx, cy, cz), excludeUnit, false, onlyVisible,  excludeAllBut);
+				result = lineVoxelCheck(Position(cx, cy, cz), excludeUnit, onlyVisible, excludeAllBut, passMin, passMax);
 				if (result != V_EMPTY)
 				{
 					if (trajectory != 0)
@@ -2295,6 +2605,141 @@ int TileEngine::calculateLine(Position origin, Position target, bool storeTrajec
 	return V_EMPTY;
 }
 
+/**
+ * Gets the tilespace blockage of a single step of a line of sight.
+ * Lines of sight fanning out from a unit share most of their steps,
+ * so the results are kept until the terrain changes.
+ * @param from The tile the step starts from.
+ * @param to The (adjacent) tile the step goes to.
+ * @param firstSteps Is this one of the first two steps of the line?
+ * @return -1 for a big wall, otherwise the amount of blockage.
+ */
+int TileEngine::sightStepBlockage(Position from, Position to, bool firstSteps)
+{
+	int direction = (to.x - from.x + 1) + (to.y - from.y + 1) * 3 + (to.z - from.z + 1) * 9;
+	std::vector<Sint16> &level = _sightBlockage[from.z];
+	if (level.empty())
+	{
+		level.assign(_save->getMapSizeX() * _save->getMapSizeY() * 27 * 2, SHRT_MIN);
+	}
+	int index = ((from.y * _save->getMapSizeX() + from.x) * 27 + direction) * 2 + (firstSteps ? 1 : 0);
+	Sint16 &cached = level[index];
+	if (cached != SHRT_MIN)
+	{
+		return cached;
+	}
+
+	Tile *startTile = _save->getTile(from);
+	Tile *endTile = _save->getTile(to);
+	int vertical = verticalBlockage(startTile, endTile, DT_NONE);
+	int result = horizontalBlockage(startTile, endTile, DT_NONE, firstSteps);
+	if (result == -1)
+	{
+		if (vertical > 127)
+		{
+			result = 0;
+		}
+		else
+		{
+			cached = -1; // We hit a big wall
+			return cached;
+		}
+	}
+	result += vertical;
+	cached = std::min(result, (int)SHRT_MAX);
+	return cached;
+}
+
+/**
+ * Calculates a line of sight in tilespace, using bresenham algorithm in 3D.
+ * Gives the same results as calculateLine() without a voxel check,
+ * but looks up the blockage of each step from a cache.
+ * @param origin Origin tile.
+ * @param target Target tile.
+ * @param trajectory A vector of positions in which the trajectory is stored.
+ * @return -1 when the line is not blocked (or stops at a big wall), otherwise the blockage where it stopped.
+ */
+int TileEngine::calculateSightLine(Position origin, Position target, std::vector<Position> *trajectory)
+{
+	if (_sightBlockageVersion != _save->getTerrainVersion() || (int)_sightBlockage.size() != _save->getMapSizeZ())
+	{
+		// levels are only filled in once a line of sight starts a step on them
+		_sightBlockage.clear();
+		_sightBlockage.resize(_save->getMapSizeZ());
+		_sightBlockageVersion = _save->getTerrainVersion();
+	}
+
+	int x, x0, x1, delta_x, step_x;
+	int y, y0, y1, delta_y, step_y;
+	int z, z0, z1, delta_z, step_z;
+	int swap_xy, swap_xz;
+	int drift_xy, drift_xz;
+	int cx, cy, cz;
+	Position lastPoint(origin);
+	int steps = 0;
+
+	x0 = origin.x;	 x1 = target.x;
+	y0 = origin.y;	 y1 = target.y;
+	z0 = origin.z;	 z1 = target.z;
+
+	swap_xy = abs(y1 - y0) > abs(x1 - x0);
+	if (swap_xy)
+	{
+		std::swap(x0, y0);
+		std::swap(x1, y1);
+	}
+	swap_xz = abs(z1 - z0) > abs(x1 - x0);
+	if (swap_xz)
+	{
+		std::swap(x0, z0);
+		std::swap(x1, z1);
+	}
+
+	delta_x = abs(x1 - x0);
+	delta_y = abs(y1 - y0);
+	delta_z = abs(z1 - z0);
+	drift_xy  = (delta_x / 2);
+	drift_xz  = (delta_x / 2);
+
+	step_x = 1;  if (x0 > x1) {  step_x = -1; }
+	step_y = 1;  if (y0 > y1) {  step_y = -1; }
+	step_z = 1;  if (z0 > z1) {  step_z = -1; }
+
+	y = y0;
+	z = z0;
+	for (x = x0; x != (x1+step_x); x += step_x)
+	{
+		cx = x;	cy = y;	cz = z;
+		if (swap_xz) std::swap(cx, cz);
+		if (swap_xy) std::swap(cx, cy);
+		Position current(cx, cy, cz);
+		trajectory->push_back(current);
+
+		int result = sightStepBlockage(lastPoint, current, steps < 2);
+		steps++;
+		if (result == -1 || result > 127)
+		{
+			return result;
+		}
+		lastPoint = current;
+
+		drift_xy = drift_xy - delta_y;
+		drift_xz = drift_xz - delta_z;
+		if (drift_xy < 0)
+		{
+			y = y + step_y;
+			drift_xy = drift_xy + delta_x;
+		}
+		if (drift_xz < 0)
+		{
+			z = z + step_z;
+			drift_xz = drift_xz + delta_x;
+		}
+	}
+
+	return V_EMPTY;
+}
+
 /**
  * Calculates a parabola trajectory, used for throwing items.
  * @param origin Origin in voxelspace.
@@ -2448,7 +2893,13 @@ int TileEngine::voxelCheck(Position voxel, BattleUnit *excludeUnit, bool exclude
 	}
 
 	// first we check terrain voxel data, not to allow 2x2 units stick through walls
-	for (int i=0; i< 4; ++i)
+	updateVoxelSummary();
+	Uint8 summary = _voxelSummary[_save->getTileIndex(tile->getPosition())];
+	if (summary < VOXELS_EMPTY)
+	{
+		return summary;
+	}
+	for (int i=0; i< 4 && summary == VOXELS_MIXED; ++i)
 	{
 		MapData *mp = tile->getMapData(i);
 		if (tile->isUfoDoorOpen(i))
@@ -2502,6 +2953,112 @@ int TileEngine::voxelCheck(Position voxel, BattleUnit *excludeUnit, bool exclude
 	return V_EMPTY;
 }
 
+/**
+ * Checks a voxel along a line. Once the line enters a tile without
+ * terrain voxels or units it could hit, the rest of that tile is
+ * passed without checking the voxels one by one.
+ * @param voxel The voxel to check.
+ * @param excludeUnit Don't do checks on this unit.
+ * @param onlyVisible Whether to consider only visible units.
+ * @param excludeAllBut If set, the only unit to be considered for ray hits.
+ * @param passMin First voxel of the tile the line passes freely.
+ * @param passMax Last voxel of the tile the line passes freely.
+ * @return The objectnumber(0-3) or unit(4) or out of map (5) or -1 (hit nothing).
+ */
+int TileEngine::lineVoxelCheck(Position voxel, BattleUnit *excludeUnit, bool onlyVisible, BattleUnit *excludeAllBut, Position &passMin, Position &passMax)
+{
+	if (voxel.x >= passMin.x && voxel.x <= passMax.x &&
+		voxel.y >= passMin.y && voxel.y <= passMax.y &&
+		voxel.z >= passMin.z && voxel.z <= passMax.z)
+	{
+		return V_EMPTY;
+	}
+	Tile *tile = 0;
+	if (voxel.x >= 0 && voxel.y >= 0 && voxel.z >= 0)
+	{
+		tile = _save->getTile(voxel / Position(16, 16, 24));
+	}
+	if (tile && _voxelSummary[_save->getTileIndex(tile->getPosition())] == VOXELS_EMPTY)
+	{
+		BattleUnit *unit = tile->getUnit();
+		if (unit == 0 && tile->hasNoFloor(0))
+		{
+			Tile *tileBelow = _save->getTile(tile->getPosition() + Position(0, 0, -1));
+			if (tileBelow) unit = tileBelow->getUnit();
+		}
+		if (_save->isBeforeGame() || unit == 0 || unit == excludeUnit || (excludeAllBut && unit != excludeAllBut) || (onlyVisible && !unit->getVisible()))
+		{
+			passMin = tile->getPosition() * Position(16, 16, 24);
+			passMax = passMin + Position(15, 15, 23);
+			return V_EMPTY;
+		}
+	}
+	return voxelCheck(voxel, excludeUnit, false, onlyVisible, excludeAllBut);
+}
+
+/**
+ * Summarizes which terrain voxels of a tile are filled, so voxel checks
+ * can skip the LOFTs of empty tiles and of tiles filled by one part.
+ * @param tile The tile to summarize.
+ * @return The part filling the whole tile, VOXELS_EMPTY or VOXELS_MIXED.
+ */
+Uint8 TileEngine::summarizeVoxels(Tile *tile) const
+{
+	MapData *floor = tile->getMapData(O_FLOOR);
+	if (floor && floor->isGravLift())
+	{
+		return VOXELS_MIXED; // grav lifts stop lines on their floor voxels
+	}
+	for (int i = 0; i < 4; ++i)
+	{
+		MapData *mp = tile->getMapData(i);
+		if (mp == 0 || tile->isUfoDoorOpen(i))
+			continue;
+		bool empty = true, full = true;
+		for (int layer = 0; layer < 12; ++layer)
+		{
+			size_t loft = mp->getLoftID(layer);
+			Uint8 summary = loft < _loftSummary.size() ? _loftSummary[loft] : (Uint8)VOXELS_MIXED;
+			empty = empty && summary == VOXELS_EMPTY;
+			full = full && summary == 0;
+		}
+		if (full)
+			return i;
+		if (!empty)
+			return VOXELS_MIXED;
+	}
+	return VOXELS_EMPTY;
+}
+
+/**
+ * Builds the terrain voxel summary of every tile, if it isn't up to date.
+ * Must be called from the main thread before lines are traced on other threads.
+ */
+void TileEngine::updateVoxelSummary()
+{
+	if (_voxelSummaryValid && (int)_voxelSummary.size() == _save->getMapSizeXYZ())
+		return;
+	_voxelSummary.resize(_save->getMapSizeXYZ());
+	for (int i = 0; i < _save->getMapSizeXYZ(); ++i)
+	{
+		_voxelSummary[i] = summarizeVoxels(_save->getTiles()[i]);
+	}
+	_voxelSummaryValid = true;
+}
+
+/**
+ * Updates the terrain voxel summary of a tile whose terrain was
+ * destroyed, or whose doors opened or closed.
+ * @param tile The tile that changed.
+ */
+void TileEngine::terrainChanged(Tile *tile)
+{
+	if (_voxelSummaryValid && (int)_voxelSummary.size() == _save->getMapSizeXYZ())
+	{
+		_voxelSummary[_save->getTileIndex(tile->getPosition())] = summarizeVoxels(tile);
+	}
+}
+
 /**
  * Toggles personal lighting on / off.
  */
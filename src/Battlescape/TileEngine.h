@@ -18,6 +18,7 @@
  * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
  */
 #include <vector>
+#include <map>
 #include "Position.h"
 #include "../Mod/RuleItem.h"
 #include <SDL.h>
@@ -41,12 +42,79 @@ private:
 	static const int MAX_VIEW_DISTANCE_SQR = MAX_VIEW_DISTANCE * MAX_VIEW_DISTANCE;
 	static const int MAX_VOXEL_VIEW_DISTANCE = MAX_VIEW_DISTANCE * 16;
 	static const int MAX_DARKNESS_TO_SEE_UNITS = 9;
+	static const int LIGHT_LAYERS = 3;
+	static const int MAX_LIGHT_CHANGES = 32;
+	/// A single light emitter on the map, such as a lamp, fire, flare or lit unit.
+	struct LightSource
+	{
+		Position center;
+		int power;
+		LightSource(Position center_, int power_) : center(center_), power(power_) {}
+		bool operator<(const LightSource &other) const;
+	};
+	/// Where a unit was looking from the last time its view swept the tiles.
+	struct FovSweep
+	{
+		Position center, eyes;
+		int direction, terrainVersion;
+		FovSweep() : direction(-1), terrainVersion(-1) {}
+	};
+	/// The units a unit saw, and everything that could change them.
+	struct FovUnits
+	{
+		Position center, eyes;
+		int direction, faction, terrainVersion, unitsVersion, fireVersion, lightVersion;
+		std::vector<BattleUnit*> units;
+		FovUnits() : direction(-1), faction(-1), terrainVersion(-1), unitsVersion(-1), fireVersion(-1), lightVersion(-1) {}
+	};
 	SavedBattleGame *_save;
 	std::vector<Uint16> *_voxelData;
 	static const int heightFromCenter[11];
-	void addLight(Position center, int power, int layer);
+	std::vector<LightSource> _lightSources[LIGHT_LAYERS];
+	bool _lightValid[LIGHT_LAYERS];
+	std::vector<int> _lightFalloff;
+	int _lightFalloffSize;
+	int _lightVersion;
+	/// Gets the light lost over a horizontal distance.
+	int getLightFalloff(int dx, int dy);
+	/// Adds the light of a single source within a region of the map.
+	void addLight(const LightSource &source, int layer, int x1, int y1, int x2, int y2);
+	/// Relights only the parts of a layer affected by changed light sources.
+	void updateLightLayer(std::vector<LightSource> &sources, int layer);
+	std::map<int, FovSweep> _fovSweeps;
+	std::map<int, FovUnits> _fovUnits;
+	std::vector<int> _fovMarked;
+	int _fovGeneration;
+	std::vector<std::vector<Sint16> > _sightBlockage;
+	int _sightBlockageVersion;
+	/// Gets the blockage of a single step of a line of sight.
+	int sightStepBlockage(Position from, Position to, bool firstSteps);
+	/// Calculates a line of sight in tilespace.
+	int calculateSightLine(Position origin, Position target, std::vector<Position> *trajectory);
 	int blockage(Tile *tile, const int part, ItemDamageType type, int direction = -1, bool checkingFromOrigin = false);
 	bool _personalLighting;
+	static const int EXPLOSION_RAYS_FI = 37;
+	static const int EXPLOSION_RAYS_TE = 121;
+	std::vector<Position> _explosionSteps;
+	int _explosionStepLength;
+	std::vector<int> _explosionVisited;
+	int _explosionGeneration;
+	std::vector<int> _explosionTiles;
+	int _explosionBatch;
+	std::vector<Position> _explosionBatchCenters;
+	/// Makes sure the explosion ray tables reach a certain distance.
+	void buildExplosionSteps(int length);
+	/// Recalculates lighting and vision after explosions.
+	void finishExplosions(const std::vector<Position> &centers);
+	/// Summary of the terrain voxels of a tile: 0-3 means the tile is filled by that part.
+	enum VoxelSummary { VOXELS_EMPTY = 4, VOXELS_MIXED = 5 };
+	std::vector<Uint8> _loftSummary;
+	std::vector<Uint8> _voxelSummary;
+	bool _voxelSummaryValid;
+	/// Summarizes the terrain voxels of a tile.
+	Uint8 summarizeVoxels(Tile *tile) const;
+	/// Checks a voxel of a line, passing through empty tiles without looking at their voxels.
+	int lineVoxelCheck(Position voxel, BattleUnit *excludeUnit, bool onlyVisible, BattleUnit *excludeAllBut, Position &passMin, Position &passMax);
 public:
 	/// Creates a new TileEngine class.
 	TileEngine(SavedBattleGame *save, std::vector<Uint16> *voxelData);
@@ -72,6 +140,10 @@ public:
 	void explode(Position center, int power, ItemDamageType type, int maxRadius, BattleUnit *unit = 0);
 	/// Checks if a destroyed tile starts an explosion.
 	Tile *checkForTerrainExplosions();
+	/// Starts a batch of chained explosions.
+	void beginExplosionBatch();
+	/// Ends a batch of chained explosions.
+	void endExplosionBatch();
 	/// Unit opens door?
 	int unitOpensDoor(BattleUnit *unit, bool rClick = false, int dir = -1);
 	/// Closes ufo doors.
@@ -112,6 +184,10 @@ public:
 	int castedShade(Position voxel);
 	/// Checks the visibility of a given voxel.
 	bool isVoxelVisible(Position voxel);
+	/// Builds the terrain voxel summary of the map.
+	void updateVoxelSummary();
+	/// Updates the terrain voxel summary of a tile.
+	void terrainChanged(Tile *tile);
 	/// Checks what type of voxel occupies this space.
 	int voxelCheck(Position voxel, BattleUnit *excludeUnit, bool excludeAllUnits = false, bool onlyVisible = false, BattleUnit *excludeAllBut = 0);
 	/// Blows this tile up.
@@ -0,0 +1,200 @@
+/*
+ * Copyright 2010-2016 OpenXcom Developers.
+ *
+ * This file is part of OpenXcom.
+ *
+ * OpenXcom is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenXcom is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "BinaryNode.h"
+
+namespace OpenXcom
+{
+
+namespace
+{
+	const int MaxDepth = 256;
+
+	enum BinaryNodeType { BINARY_NULL, BINARY_SCALAR, BINARY_SEQUENCE, BINARY_MAP };
+}
+
+/**
+ * Appends a number, least significant byte first.
+ * @param out Data to append to.
+ * @param value Number.
+ */
+void BinaryNode::writeInt(std::string &out, Uint32 value)
+{
+	for (int i = 0; i < 4; ++i)
+	{
+		out += (char)((value >> (i * 8)) & 0xFF);
+	}
+}
+
+/**
+ * Reads a number, least significant byte first.
+ * @param in Data to read from.
+ * @param pos Position to read from, moved past the number.
+ * @param value Number read.
+ * @return False if there's not enough data.
+ */
+bool BinaryNode::readInt(const std::string &in, size_t &pos, Uint32 &value)
+{
+	if (pos > in.size() || in.size() - pos < 4)
+	{
+		return false;
+	}
+	value = 0;
+	for (int i = 0; i < 4; ++i)
+	{
+		value |= (Uint32)(Uint8)in[pos + i] << (i * 8);
+	}
+	pos += 4;
+	return true;
+}
+
+/**
+ * Appends a string with its length.
+ * @param out Data to append to.
+ * @param s String.
+ */
+void BinaryNode::writeString(std::string &out, const std::string &s)
+{
+	writeInt(out, s.size());
+	out += s;
+}
+
+/**
+ * Reads a string with its length.
+ * @param in Data to read from.
+ * @param pos Position to read from, moved past the string.
+ * @param s String read.
+ * @return False if there's not enough data.
+ */
+bool BinaryNode::readString(const std::string &in, size_t &pos, std::string &s)
+{
+	Uint32 size;
+	if (!readInt(in, pos, size) || in.size() - pos < size)
+	{
+		return false;
+	}
+	s.assign(in, pos, size);
+	pos += size;
+	return true;
+}
+
+/**
+ * Appends a node and all its children.
+ * @param out Data to append to.
+ * @param node YAML node.
+ */
+void BinaryNode::write(std::string &out, const YAML::Node &node)
+{
+	switch (node.Type())
+	{
+	case YAML::NodeType::Scalar:
+		out += (char)BINARY_SCALAR;
+		writeString(out, node.Scalar());
+		break;
+	case YAML::NodeType::Sequence:
+		out += (char)BINARY_SEQUENCE;
+		writeInt(out, node.size());
+		for (YAML::const_iterator i = node.begin(); i != node.end(); ++i)
+		{
+			write(out, *i);
+		}
+		break;
+	case YAML::NodeType::Map:
+		out += (char)BINARY_MAP;
+		writeInt(out, node.size());
+		for (YAML::const_iterator i = node.begin(); i != node.end(); ++i)
+		{
+			write(out, i->first);
+			write(out, i->second);
+		}
+		break;
+	default:
+		out += (char)BINARY_NULL;
+		break;
+	}
+}
+
+/**
+ * Reads a node and all its children.
+ * @param in Data to read from.
+ * @param pos Position to read from, moved past the node.
+ * @param node YAML node to fill in.
+ * @param depth How deep the node is nested.
+ * @return False if the data is damaged.
+ */
+bool BinaryNode::read(const std::string &in, size_t &pos, YAML::Node &node, int depth)
+{
+	if (pos >= in.size() || depth > MaxDepth)
+	{
+		return false;
+	}
+	char type = in[pos++];
+	Uint32 size;
+	switch (type)
+	{
+	case BINARY_NULL:
+		node = YAML::Node(YAML::NodeType::Null);
+		return true;
+	case BINARY_SCALAR:
+		{
+			std::string scalar;
+			if (!readString(in, pos, scalar))
+			{
+				return false;
+			}
+			node = YAML::Node(scalar);
+			return true;
+		}
+	case BINARY_SEQUENCE:
+		if (!readInt(in, pos, size))
+		{
+			return false;
+		}
+		node = YAML::Node(YAML::NodeType::Sequence);
+		for (Uint32 i = 0; i < size; ++i)
+		{
+			YAML::Node child;
+			if (!read(in, pos, child, depth + 1))
+			{
+				return false;
+			}
+			node.push_back(child);
+		}
+		return true;
+	case BINARY_MAP:
+		if (!readInt(in, pos, size))
+		{
+			return false;
+		}
+		node = YAML::Node(YAML::NodeType::Map);
+		for (Uint32 i = 0; i < size; ++i)
+		{
+			YAML::Node key, value;
+			if (!read(in, pos, key, depth + 1) || !read(in, pos, value, depth + 1))
+			{
+				return false;
+			}
+			node[key] = value;
+		}
+		return true;
+	default:
+		return false;
+	}
+}
+
+}
@@ -0,0 +1,49 @@
+#pragma once
+/*
+ * Copyright 2010-2016 OpenXcom Developers.
+ *
+ * This file is part of OpenXcom.
+ *
+ * OpenXcom is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenXcom is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <string>
+#include <yaml-cpp/yaml.h>
+#include <SDL_types.h>
+
+namespace OpenXcom
+{
+
+/**
+ * Writes YAML nodes in a compact binary form and reads them back,
+ * for files that only the game reads, like caches and binary saves.
+ * Much quicker than emitting and parsing YAML text.
+ */
+class BinaryNode
+{
+public:
+	/// Appends a number.
+	static void writeInt(std::string &out, Uint32 value);
+	/// Reads a number.
+	static bool readInt(const std::string &in, size_t &pos, Uint32 &value);
+	/// Appends a string.
+	static void writeString(std::string &out, const std::string &s);
+	/// Reads a string.
+	static bool readString(const std::string &in, size_t &pos, std::string &s);
+	/// Appends a node and its children.
+	static void write(std::string &out, const YAML::Node &node);
+	/// Reads a node and its children.
+	static bool read(const std::string &in, size_t &pos, YAML::Node &node, int depth = 0);
+};
+
+}
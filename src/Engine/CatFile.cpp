@@ -18,36 +18,47 @@
  */
 
 #include "CatFile.h"
+#include <algorithm>
+#include <cstring>
 #include <SDL.h>
 
 namespace OpenXcom
 {
 
 /**
- * Creates a CAT file stream. A CAT file starts with an index of the
+ * Opens a CAT file. A CAT file starts with an index of the
  * offset and size of every file contained within. Each file consists
  * of a filename followed by its contents.
  * @param path Full path to CAT file.
  */
-CatFile::CatFile(const char *path) : std::ifstream(path, std::ios::in | std::ios::binary), _amount(0), _offset(0), _size(0)
+CatFile::CatFile(const char *path) : _file(path), _amount(0), _offset(0), _size(0)
 {
+	const Uint8 *data = _file.data();
+	size_t size = _file.size();
+
 	// Get amount of files
-	read((char*)&_amount, sizeof(_amount));
+	if (size >= sizeof(_amount))
+	{
+		memcpy(&_amount, data, sizeof(_amount));
+	}
 
 	_amount = (unsigned int)SDL_SwapLE32(_amount);
 	_amount /= 2 * sizeof(_amount);
+	// the index can't be bigger than the file
+	if (_amount > size / (2 * sizeof(_amount)))
+	{
+		_amount = size / (2 * sizeof(_amount));
+	}
 
 	// Get object offsets
-	seekg(0, std::ios::beg);
-
 	_offset = new unsigned int[_amount];
 	_size   = new unsigned int[_amount];
 
 	for (unsigned int i = 0; i < _amount; ++i)
 	{
-		read((char*)&_offset[i], sizeof(*_offset));
+		memcpy(&_offset[i], data + i * 2 * sizeof(*_offset), sizeof(*_offset));
 		_offset[i] = (unsigned int)SDL_SwapLE32(_offset[i]);
-		read((char*)&_size[i],   sizeof(*_size));
+		memcpy(&_size[i], data + i * 2 * sizeof(*_offset) + sizeof(*_offset), sizeof(*_size));
 		_size[i] = (unsigned int)SDL_SwapLE32(_size[i]);
 	}
 }
@@ -59,8 +70,6 @@ CatFile::~CatFile()
 {
 	delete[] _offset;
 	delete[] _size;
-
-	close();
 }
 
 /**
@@ -74,15 +83,16 @@ char *CatFile::load(unsigned int i, bool name)
 	if (i >= _amount)
 		return 0;
 
-	seekg(_offset[i], std::ios::beg);
+	size_t pos = _offset[i];
+	size_t end = _file.size();
 
-	unsigned char namesize = peek();
+	unsigned char namesize = (pos < end) ? _file.data()[pos] : 255;
 	// Skip filename (if there's any)
 	if (namesize<=56)
 	{
 		if (!name)
 		{
-			seekg(namesize + 1, std::ios::cur);
+			pos += namesize + 1;
 		}
 		else
 		{
@@ -90,9 +100,14 @@ char *CatFile::load(unsigned int i, bool name)
 		}
 	}
 
-	// Read object
+	// Read object, anything past the end of the file is left blank
 	char *object = new char[_size[i]];
-	read(object, _size[i]);
+	size_t available = (pos < end) ? std::min<size_t>(_size[i], end - pos) : 0;
+	if (available != 0)
+	{
+		memcpy(object, _file.data() + pos, available);
+	}
+	memset(object + available, 0, _size[i] - available);
 
 	return object;
 }
@@ -61,6 +61,7 @@
 #include <cstdio>
 #include <cstdlib>
 #include <unistd.h>
+#include <sys/time.h>
 #include <sys/param.h>
 #include <sys/types.h>
 #include <pwd.h>
@@ -1028,6 +1029,29 @@ std::string now()
 	return result;
 }
 
+/**
+ * Reads a high resolution clock, for profiling
+ * code that runs faster than SDL_GetTicks can measure.
+ * @return Time elapsed since an arbitrary point, in microseconds.
+ */
+Uint64 getMicroseconds()
+{
+#ifdef _WIN32
+	static LARGE_INTEGER frequency = { 0 };
+	if (frequency.QuadPart == 0)
+	{
+		QueryPerformanceFrequency(&frequency);
+	}
+	LARGE_INTEGER counter;
+	QueryPerformanceCounter(&counter);
+	return (Uint64)(counter.QuadPart / frequency.QuadPart) * 1000000 + (Uint64)(counter.QuadPart % frequency.QuadPart) * 1000000 / frequency.QuadPart;
+#else
+	struct timeval tv;
+	gettimeofday(&tv, 0);
+	return (Uint64)tv.tv_sec * 1000000 + tv.tv_usec;
+#endif
+}
+
 /**
  * Logs the details of this crash and shows an error.
  * @param ex Pointer to exception data (PEXCEPTION_POINTERS on Windows, signal int on Unix)
@@ -95,6 +95,8 @@ namespace CrossPlatform
 	void stackTrace(void *ctx);
 	/// Produces a quick timestamp.
 	std::string now();
+	/// Gets a high resolution clock reading.
+	Uint64 getMicroseconds();
 	/// Produces a crash dump.
 	void crashDump(void *ex, const std::string &err);
 }
@@ -187,6 +187,7 @@ void Game::run()
 					{
 						case SDL_APPACTIVE:
 							runningState = reinterpret_cast<SDL_ActiveEvent*>(&_event)->gain ? RUNNING : stateRun[Options::pauseMode];
+							_screen->invalidate();
 							break;
 						case SDL_APPMOUSEFOCUS:
 							// We consciously ignore it.
@@ -281,7 +282,8 @@ void Game::run()
 				// make a note of when this frame update occurred.
 				_timeOfLastFrame = SDL_GetTicks();
 				_fpsCounter->addFrame();
-				_screen->clear();
+				// the window itself only gets redrawn where the picture changed
+				_screen->getSurface()->clear();
 				std::list<State*>::iterator i = _states.end();
 				do
 				{
@@ -0,0 +1,145 @@
+/*
+ * Copyright 2010-2016 OpenXcom Developers.
+ *
+ * This file is part of OpenXcom.
+ *
+ * OpenXcom is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenXcom is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "MappedFile.h"
+#include <fstream>
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#elif defined(__unix__) || defined(__APPLE__)
+#define MAPPED_FILE_MMAP
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace OpenXcom
+{
+
+/**
+ * Opens a file and maps its contents into memory. If the file can't
+ * be mapped (empty files, or systems without mapping) it's read into
+ * memory instead.
+ * @param path Full path to the file.
+ */
+MappedFile::MappedFile(const std::string &path) : _data(0), _size(0), _open(false), _mapped(false), _handle(0)
+{
+	_open = map(path) || read(path);
+}
+
+/**
+ * Unmaps the file from memory.
+ */
+MappedFile::~MappedFile()
+{
+	if (_mapped)
+	{
+#ifdef _WIN32
+		UnmapViewOfFile(_data);
+		CloseHandle((HANDLE)_handle);
+#elif defined(MAPPED_FILE_MMAP)
+		munmap((void*)_data, _size);
+#endif
+	}
+}
+
+/**
+ * Maps a file into memory.
+ * @param path Full path to the file.
+ * @return True if the file was mapped.
+ */
+bool MappedFile::map(const std::string &path)
+{
+#ifdef _WIN32
+	HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, 0, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, 0);
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+	LARGE_INTEGER size;
+	HANDLE mapping = 0;
+	if (GetFileSizeEx(file, &size) && size.QuadPart > 0)
+	{
+		mapping = CreateFileMappingA(file, 0, PAGE_READONLY, 0, 0, 0);
+	}
+	CloseHandle(file);
+	if (mapping == 0)
+	{
+		return false;
+	}
+	void *view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	if (view == 0)
+	{
+		CloseHandle(mapping);
+		return false;
+	}
+	_data = (const Uint8*)view;
+	_size = (size_t)size.QuadPart;
+	_handle = mapping;
+	_mapped = true;
+	return true;
+#elif defined(MAPPED_FILE_MMAP)
+	int file = open(path.c_str(), O_RDONLY);
+	if (file < 0)
+	{
+		return false;
+	}
+	struct stat info;
+	void *view = MAP_FAILED;
+	if (fstat(file, &info) == 0 && info.st_size > 0)
+	{
+		view = mmap(0, info.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+	}
+	close(file);
+	if (view == MAP_FAILED)
+	{
+		return false;
+	}
+	_data = (const Uint8*)view;
+	_size = info.st_size;
+	_mapped = true;
+	return true;
+#else
+	(void)path;
+	return false;
+#endif
+}
+
+/**
+ * Reads a whole file into memory.
+ * @param path Full path to the file.
+ * @return True if the file was read.
+ */
+bool MappedFile::read(const std::string &path)
+{
+	std::ifstream file(path.c_str(), std::ios::in | std::ios::binary);
+	if (!file)
+	{
+		return false;
+	}
+	_buffer.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+	_data = _buffer.empty() ? 0 : &_buffer[0];
+	_size = _buffer.size();
+	return true;
+}
+
+}
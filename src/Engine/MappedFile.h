@@ -0,0 +1,61 @@
+#pragma once
+/*
+ * Copyright 2010-2016 OpenXcom Developers.
+ *
+ * This file is part of OpenXcom.
+ *
+ * OpenXcom is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenXcom is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <string>
+#include <vector>
+#include <SDL_types.h>
+
+namespace OpenXcom
+{
+
+/**
+ * A read-only view of a whole file's contents, mapped into memory
+ * where the system supports it, so resource loaders can decode
+ * straight from the bytes instead of reading a stream piece by piece.
+ */
+class MappedFile
+{
+private:
+	const Uint8 *_data;
+	size_t _size;
+	bool _open, _mapped;
+	void *_handle;
+	std::vector<Uint8> _buffer;
+
+	// Disable copy and assignments.
+	MappedFile(const MappedFile &);
+	MappedFile &operator=(const MappedFile &);
+	/// Maps a file into memory.
+	bool map(const std::string &path);
+	/// Reads a file into a buffer instead.
+	bool read(const std::string &path);
+public:
+	/// Opens a file for reading.
+	MappedFile(const std::string &path);
+	/// Closes the file.
+	~MappedFile();
+	/// Checks if the file was opened.
+	bool isOpen() const { return _open; }
+	/// Gets the contents of the file.
+	const Uint8 *data() const { return _data; }
+	/// Gets the size of the file.
+	size_t size() const { return _size; }
+};
+
+}
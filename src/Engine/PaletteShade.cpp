@@ -0,0 +1,233 @@
+/*
+ * Copyright 2010-2016 OpenXcom Developers.
+ *
+ * This file is part of OpenXcom.
+ *
+ * OpenXcom is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenXcom is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "PaletteShade.h"
+#include <vector>
+#include <algorithm>
+#include "Zoom.h"
+#include "Logger.h"
+#include "CrossPlatform.h"
+
+#if (_MSC_VER >= 1400) || (defined(__MINGW32__) && defined(__SSE2__))
+#ifndef __SSE2__
+#define __SSE2__ true
+#endif
+#endif
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define PALETTE_SHADE_NEON
+#include <arm_neon.h>
+#endif
+
+namespace OpenXcom
+{
+
+PaletteShade::RowFunc PaletteShade::_row = 0;
+const char *PaletteShade::_rowName = "scalar";
+
+/**
+ * Shades a row of pixels one pixel at a time. A pixel gets darker by
+ * the shade, turning black if that takes it past the darkest shade of
+ * its color group. Transparent (0) source pixels are skipped.
+ * @param dest Destination pixels.
+ * @param src Source pixels.
+ * @param count Number of pixels.
+ * @param shade Amount of shade to add.
+ * @param group Color group (shifted by 4) to replace the source's with, or -1 to keep it.
+ */
+void PaletteShade::shadeRowScalar(Uint8 *dest, const Uint8 *src, int count, int shade, int group)
+{
+	for (int i = 0; i < count; ++i)
+	{
+		if (src[i])
+		{
+			const int newShade = (src[i]&15) + shade;
+			if (newShade > 15)
+				// so dark it would flip over to another color - make it black instead
+				dest[i] = 15;
+			else
+				dest[i] = (group < 0 ? (src[i]&(15<<4)) : group) | newShade;
+		}
+	}
+}
+
+#ifdef __SSE2__
+/**
+ * Shades a row of pixels 16 at a time with SSE2.
+ * Only handles shades from 0 up, and color groups that fit in a byte.
+ */
+static void shadeRowSSE2(Uint8 *dest, const Uint8 *src, int count, int shade, int group)
+{
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i low = _mm_set1_epi8(15);
+	const __m128i high = _mm_set1_epi8((char)(15<<4));
+	const __m128i shades = _mm_set1_epi8((char)std::min(shade, 16));
+	const __m128i groups = _mm_set1_epi8((char)std::max(group, 0));
+	int i = 0;
+	for (; i + 16 <= count; i += 16)
+	{
+		__m128i s = _mm_loadu_si128((const __m128i*)(src + i));
+		__m128i d = _mm_loadu_si128((const __m128i*)(dest + i));
+		__m128i newShade = _mm_add_epi8(_mm_and_si128(s, low), shades);
+		__m128i black = _mm_cmpgt_epi8(newShade, low);
+		__m128i color = _mm_or_si128(group < 0 ? _mm_and_si128(s, high) : groups, newShade);
+		color = _mm_or_si128(_mm_and_si128(black, low), _mm_andnot_si128(black, color));
+		__m128i transparent = _mm_cmpeq_epi8(s, zero);
+		d = _mm_or_si128(_mm_and_si128(transparent, d), _mm_andnot_si128(transparent, color));
+		_mm_storeu_si128((__m128i*)(dest + i), d);
+	}
+	PaletteShade::shadeRowScalar(dest + i, src + i, count - i, shade, group);
+}
+#endif
+
+#ifdef PALETTE_SHADE_NEON
+/**
+ * Shades a row of pixels 16 at a time with NEON.
+ * Only handles shades from 0 up, and color groups that fit in a byte.
+ */
+static void shadeRowNEON(Uint8 *dest, const Uint8 *src, int count, int shade, int group)
+{
+	const uint8x16_t low = vdupq_n_u8(15);
+	const uint8x16_t high = vdupq_n_u8(15<<4);
+	const uint8x16_t shades = vdupq_n_u8((Uint8)std::min(shade, 16));
+	const uint8x16_t groups = vdupq_n_u8((Uint8)std::max(group, 0));
+	int i = 0;
+	for (; i + 16 <= count; i += 16)
+	{
+		uint8x16_t s = vld1q_u8(src + i);
+		uint8x16_t d = vld1q_u8(dest + i);
+		uint8x16_t newShade = vaddq_u8(vandq_u8(s, low), shades);
+		uint8x16_t black = vcgtq_u8(newShade, low);
+		uint8x16_t color = vorrq_u8(group < 0 ? vandq_u8(s, high) : groups, newShade);
+		color = vbslq_u8(black, low, color);
+		uint8x16_t transparent = vceqq_u8(s, vdupq_n_u8(0));
+		vst1q_u8(dest + i, vbslq_u8(transparent, d, color));
+	}
+	PaletteShade::shadeRowScalar(dest + i, src + i, count - i, shade, group);
+}
+#endif
+
+/**
+ * Picks the fastest way to shade rows on this CPU.
+ */
+void PaletteShade::select()
+{
+	_row = &shadeRowScalar;
+	_rowName = "scalar";
+#ifdef __SSE2__
+	if (Zoom::haveSSE2())
+	{
+		_row = &shadeRowSSE2;
+		_rowName = "SSE2";
+	}
+#endif
+#ifdef PALETTE_SHADE_NEON
+	_row = &shadeRowNEON;
+	_rowName = "NEON";
+#endif
+}
+
+/**
+ * Shades a row of pixels on top of another, skipping transparent ones.
+ * @param dest Destination pixels.
+ * @param src Source pixels.
+ * @param count Number of pixels.
+ * @param shade Amount of shade to add.
+ * @param group Color group (shifted by 4) to replace the source's with, or -1 to keep it.
+ */
+void PaletteShade::shadeRow(Uint8 *dest, const Uint8 *src, int count, int shade, int group)
+{
+	if (!_row)
+	{
+		select();
+	}
+	// the vector versions work on bytes, odd shades and groups are left to the scalar one
+	if (shade < 0 || group > 255 || count < 16)
+	{
+		shadeRowScalar(dest, src, count, shade, group);
+	}
+	else
+	{
+		_row(dest, src, count, shade, group);
+	}
+}
+
+/**
+ * Shades random sprite rows with both the scalar and the selected
+ * vector version, checks that they come out the same, and logs how
+ * long each took.
+ */
+void PaletteShade::benchmark()
+{
+	if (!_row)
+	{
+		select();
+	}
+	const int width = 32, rows = 40, repeats = 20000;
+	std::vector<Uint8> src(width * rows), background(width * rows), scalar(width * rows), vector(width * rows);
+	Uint32 seed = 1;
+	for (size_t i = 0; i < src.size(); ++i)
+	{
+		seed = seed * 1103515245 + 12345;
+		src[i] = (seed >> 16) % 4 == 0 ? 0 : (Uint8)(seed >> 8);
+		background[i] = (Uint8)(seed >> 20);
+	}
+
+	bool identical = true;
+	for (int shade = 0; shade <= 16 && identical; ++shade)
+	{
+		for (int group = -1; group < 256 && identical; group += 16)
+		{
+			scalar = background;
+			vector = background;
+			for (int y = 0; y < rows; ++y)
+			{
+				shadeRowScalar(&scalar[y * width], &src[y * width], width - y % 7, shade, group);
+				_row(&vector[y * width], &src[y * width], width - y % 7, shade, group);
+			}
+			identical = scalar == vector;
+		}
+	}
+
+	Uint64 start = CrossPlatform::getMicroseconds();
+	for (int i = 0; i < repeats; ++i)
+	{
+		for (int y = 0; y < rows; ++y)
+		{
+			shadeRowScalar(&scalar[y * width], &src[y * width], width, i & 15, -1);
+		}
+	}
+	Uint64 scalarTime = CrossPlatform::getMicroseconds() - start;
+	start = CrossPlatform::getMicroseconds();
+	for (int i = 0; i < repeats; ++i)
+	{
+		for (int y = 0; y < rows; ++y)
+		{
+			_row(&vector[y * width], &src[y * width], width, i & 15, -1);
+		}
+	}
+	Uint64 vectorTime = CrossPlatform::getMicroseconds() - start;
+
+	Log(LOG_INFO) << "Shading " << repeats << " sprites: scalar " << scalarTime / 1000.0 << " ms, " << _rowName << " " << vectorTime / 1000.0 << " ms, output " << (identical ? "identical" : "DIFFERENT");
+}
+
+}
@@ -0,0 +1,49 @@
+#pragma once
+/*
+ * Copyright 2010-2016 OpenXcom Developers.
+ *
+ * This file is part of OpenXcom.
+ *
+ * OpenXcom is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenXcom is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <SDL.h>
+
+namespace OpenXcom
+{
+
+/**
+ * Shades rows of 8bpp palette pixels, like the terrain and unit
+ * sprites drawn with Surface::blitNShade. Uses vector instructions
+ * when the CPU has them, picked the first time a row is shaded.
+ */
+class PaletteShade
+{
+public:
+	/// A function that shades a row of pixels.
+	typedef void (*RowFunc)(Uint8 *dest, const Uint8 *src, int count, int shade, int group);
+private:
+	static RowFunc _row;
+	static const char *_rowName;
+	/// Picks the fastest way to shade rows on this CPU.
+	static void select();
+public:
+	/// Shades a row of pixels on top of another, skipping transparent ones.
+	static void shadeRow(Uint8 *dest, const Uint8 *src, int count, int shade, int group = -1);
+	/// Shades a row of pixels one pixel at a time.
+	static void shadeRowScalar(Uint8 *dest, const Uint8 *src, int count, int shade, int group);
+	/// Compares the vector and scalar shading for speed and identical output.
+	static void benchmark();
+};
+
+}
@@ -31,6 +31,7 @@
 #include "CrossPlatform.h"
 #include "FileMap.h"
 #include "Zoom.h"
+#include "PaletteShade.h"
 #include "Timer.h"
 #include <SDL.h>
 
@@ -104,7 +105,7 @@ void Screen::makeVideoFlags()
  * Initializes a new display screen for the game to render contents to.
  * The screen is set up based on the current options.
  */
-Screen::Screen() : _baseWidth(ORIGINAL_WIDTH), _baseHeight(ORIGINAL_HEIGHT), _scaleX(1.0), _scaleY(1.0), _flags(0), _numColors(0), _firstColor(0), _pushPalette(false), _surface(0)
+Screen::Screen() : _baseWidth(ORIGINAL_WIDTH), _baseHeight(ORIGINAL_HEIGHT), _scaleX(1.0), _scaleY(1.0), _flags(0), _numColors(0), _firstColor(0), _pushPalette(false), _surface(0), _redrawAll(true)
 {
 	resetDisplay();
 	memset(deferredPalette, 0, 256*sizeof(SDL_Color));
@@ -116,6 +117,7 @@ Screen::Screen() : _baseWidth(ORIGINAL_WIDTH), _baseHeight(ORIGINAL_HEIGHT), _sc
  */
 Screen::~Screen()
 {
+	Zoom::setThreads(0);
 	delete _surface;
 }
 
@@ -138,7 +140,12 @@ void Screen::handle(Action *action)
 {
 	if (Options::debug)
 	{
-		if (action->getDetails()->type == SDL_KEYDOWN && action->getDetails()->key.keysym.sym == SDLK_F8)
+		if (action->getDetails()->type == SDL_KEYDOWN && action->getDetails()->key.keysym.sym == SDLK_F8 && (SDL_GetModState() & KMOD_CTRL) != 0)
+		{
+			Zoom::benchmark(_baseWidth, _baseHeight);
+			PaletteShade::benchmark();
+		}
+		else if (action->getDetails()->type == SDL_KEYDOWN && action->getDetails()->key.keysym.sym == SDLK_F8)
 		{
 			switch(Timer::gameSlowSpeed)
 			{
@@ -149,6 +156,11 @@ void Screen::handle(Action *action)
 		}
 	}
 	
+	if (action->getDetails()->type == SDL_VIDEOEXPOSE)
+	{
+		invalidate();
+	}
+
 	if (action->getDetails()->type == SDL_KEYDOWN && action->getDetails()->key.keysym.sym == SDLK_RETURN && (SDL_GetModState() & KMOD_ALT) != 0)
 	{
 		Options::fullscreen = !Options::fullscreen;
@@ -171,18 +183,93 @@ void Screen::handle(Action *action)
 }
 
 
+/**
+ * Compares the buffer with the last frame that was put on screen,
+ * and keeps a copy of any rows that changed for the next comparison.
+ * @param top Returns the first row that changed.
+ * @param bottom Returns the row after the last one that changed.
+ * @return Whether anything changed at all.
+ */
+bool Screen::findChangedRows(int *top, int *bottom)
+{
+	SDL_Surface *surface = _surface->getSurface();
+	Uint8 *pixels = (Uint8*)surface->pixels;
+	size_t size = surface->pitch * surface->h;
+	if (_lastFrame.size() != size)
+	{
+		_lastFrame.assign(pixels, pixels + size);
+		*top = 0;
+		*bottom = surface->h;
+		return true;
+	}
+
+	int rowBytes = surface->w * surface->format->BytesPerPixel;
+	int first = -1, last = -1;
+	for (int y = 0; y < surface->h; ++y)
+	{
+		Uint8 *row = pixels + y * surface->pitch;
+		Uint8 *lastRow = &_lastFrame[y * surface->pitch];
+		if (memcmp(row, lastRow, rowBytes) != 0)
+		{
+			memcpy(lastRow, row, rowBytes);
+			if (first == -1)
+				first = y;
+			last = y;
+		}
+	}
+	if (first == -1)
+	{
+		return false;
+	}
+	*top = first;
+	*bottom = last + 1;
+	return true;
+}
+
 /**
  * Renders the buffer's contents onto the screen, applying
  * any necessary filters or conversions in the process.
  * If the scaling factor is bigger than 1, the entire contents
  * of the buffer are resized by that factor (eg. 2 = doubled)
  * before being put on screen.
+ * Frames identical to the last one aren't rendered at all, and
+ * on single-buffered displays only the rows that changed are
+ * scaled and updated, when the scaler allows it.
  */
 void Screen::flip()
 {
+	int top = 0, bottom = _baseHeight;
+	if (!findChangedRows(&top, &bottom) && !_redrawAll)
+	{
+		return;
+	}
+
+	// double buffers and OpenGL need the whole picture every time
+	bool partial = !_redrawAll && !isOpenGLEnabled() && !(_screen->flags & SDL_DOUBLEBUF);
+	int rowHeight = 1;
+	if (_redrawAll)
+	{
+		if (_screen->flags & SDL_SWSURFACE) memset(_screen->pixels, 0, _screen->h*_screen->pitch);
+		else SDL_FillRect(_screen, &_clear, 0);
+	}
+
 	if (getWidth() != _baseWidth || getHeight() != _baseHeight || isOpenGLEnabled())
 	{
-		Zoom::flipWithZoom(_surface->getSurface(), _screen, _topBlackBand, _bottomBlackBand, _leftBlackBand, _rightBlackBand, &glOutput);
+		if (partial && Zoom::zoomRows(_surface->getSurface(), _screen, &top, &bottom))
+		{
+			rowHeight = getHeight() / _baseHeight;
+		}
+		else
+		{
+			Zoom::flipWithZoom(_surface->getSurface(), _screen, _topBlackBand, _bottomBlackBand, _leftBlackBand, _rightBlackBand, &glOutput);
+			partial = false;
+		}
+	}
+	else if (partial)
+	{
+		SDL_Rect srcRect = {0, (Sint16)top, (Uint16)_baseWidth, (Uint16)(bottom - top)};
+		SDL_Rect dstRect = srcRect;
+		SDL_BlitSurface(_surface->getSurface(), &srcRect, _screen, &dstRect);
 	}
 	else
 	{
@@ -202,20 +289,34 @@ void Screen::flip()
 
 
 	
-	if (SDL_Flip(_screen) == -1)
+	if (partial)
+	{
+		SDL_UpdateRect(_screen, 0, top * rowHeight, getWidth(), (bottom - top) * rowHeight);
+	}
+	else if (SDL_Flip(_screen) == -1)
 	{
 		throw Exception(SDL_GetError());
 	}
+	_redrawAll = false;
 }
 
 /**
- * Clears all the contents out of the internal buffer.
+ * Clears all the contents out of the internal buffer,
+ * and the game window along with it on the next flip.
  */
 void Screen::clear()
 {
 	_surface->clear();
-	if (_screen->flags & SDL_SWSURFACE) memset(_screen->pixels, 0, _screen->h*_screen->pitch);
-	else SDL_FillRect(_screen, &_clear, 0);
+	invalidate();
+}
+
+/**
+ * Makes the next flip redraw the whole game window, for when
+ * its contents were lost or the palette changed.
+ */
+void Screen::invalidate()
+{
+	_redrawAll = true;
 }
 
 /**
@@ -242,6 +343,7 @@ void Screen::setPalette(SDL_Color* colors, int firstcolor, int ncolors, bool imm
 	}
 
 	_surface->setPalette(colors, firstcolor, ncolors);
+	invalidate();
 
 	// defer actual update of screen until SDL_Flip()
 	if (immediately && _screen->format->BitsPerPixel == 8 && SDL_SetColors(_screen, colors, firstcolor, ncolors) == 0)
@@ -367,6 +469,8 @@ void Screen::resetDisplay(bool resetVideo)
 	_clear.y = 0;
 	_clear.w = getWidth();
 	_clear.h = getHeight();
+	invalidate();
+	Zoom::setThreads(Options::scalerThreads);
 
 	double pixelRatioY = 1.0;
 	if (Options::nonSquarePixelRatio && !Options::allowResize)
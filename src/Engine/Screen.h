@@ -19,6 +19,7 @@
  */
 #include <SDL.h>
 #include <string>
+#include <vector>
 #include "OpenGL.h"
 
 namespace OpenXcom
@@ -50,8 +51,12 @@ private:
 	OpenGL glOutput;
 	Surface *_surface;
 	SDL_Rect _clear;
+	std::vector<Uint8> _lastFrame;
+	bool _redrawAll;
 	/// Sets the _flags and _bpp variables based on game options; needed in more than one place now
 	void makeVideoFlags();
+	/// Finds the rows of the buffer that changed since the last frame.
+	bool findChangedRows(int *top, int *bottom);
 public:
 	static const int ORIGINAL_WIDTH;
 	static const int ORIGINAL_HEIGHT;
@@ -72,6 +77,8 @@ public:
 	void flip();
 	/// Clears the screen.
 	void clear();
+	/// Redraws the whole game window on the next flip.
+	void invalidate();
 	/// Sets the screen's 8bpp palette.
 	void setPalette(SDL_Color *colors, int firstcolor = 0, int ncolors = 256, bool immediately = false);
 	/// Gets the screen's 8bpp palette.
@@ -650,6 +650,24 @@ struct controler<ShaderBase<Pixel> > : public controler_base<typename ShaderBase
 	
 };
 
+/**
+ * Draws a row of pixels, one pixel at a time.
+ * Color functions that can handle whole rows of plain surfaces
+ * at once specialize this for themselves.
+ */
+template<typename ColorFunc>
+struct draw_row
+{
+	template<typename DestType, typename Src0Type, typename Src1Type, typename Src2Type, typename Src3Type>
+	static inline void draw(DestType& dest, Src0Type& src0, Src1Type& src1, Src2Type& src2, Src3Type& src3, int count)
+	{
+		for (int x = count; x>0; --x, dest.inc_x(), src0.inc_x(), src1.inc_x(), src2.inc_x(), src3.inc_x())
+		{
+			ColorFunc::func(dest.get_ref(), src0.get_ref(), src1.get_ref(), src2.get_ref(), src3.get_ref());
+		}
+	}
+};
+
 }//namespace helper
 
 }//namespace OpenXcom
@@ -28,6 +28,7 @@
 #include "Exception.h"
 #include "Logger.h"
 #include "ShaderMove.h"
+#include "PaletteShade.h"
 #include <stdlib.h>
 #ifdef _WIN32
 #include <malloc.h>
@@ -135,7 +136,7 @@ inline void DeleteAligned(void* buffer)
  * @param y Y position in pixels.
  * @param bpp Bits-per-pixel depth.
  */
-Surface::Surface(int width, int height, int x, int y, int bpp) : _x(x), _y(y), _visible(true), _hidden(false), _redraw(false), _tftdMode(false), _alignedBuffer(0)
+Surface::Surface(int width, int height, int x, int y, int bpp) : _x(x), _y(y), _visible(true), _hidden(false), _redraw(false), _tftdMode(false), _alignedBuffer(0), _ownBuffer(true)
 {
 	_alignedBuffer = NewAligned(bpp, width, height);
 	_surface = SDL_CreateRGBSurfaceFrom(_alignedBuffer, width, height, bpp, GetPitch(bpp, width), 0, 0, 0, 0);
@@ -157,11 +158,40 @@ Surface::Surface(int width, int height, int x, int y, int bpp) : _x(x), _y(y), _
 	_clear.h = getHeight();
 }
 
+/**
+ * Sets up an 8bpp surface drawing into pixels owned by someone else,
+ * like the frames of a surface set sharing one block of memory.
+ * The pixels must stay around for as long as the surface.
+ * @param width Width in pixels.
+ * @param height Height in pixels.
+ * @param pixels Blank pixels from allocateBuffer, at least getBufferSize() long.
+ */
+Surface::Surface(int width, int height, Uint8 *pixels) : _x(0), _y(0), _visible(true), _hidden(false), _redraw(false), _tftdMode(false), _alignedBuffer(pixels), _ownBuffer(false)
+{
+	_surface = SDL_CreateRGBSurfaceFrom(_alignedBuffer, width, height, 8, GetPitch(8, width), 0, 0, 0, 0);
+
+	if (_surface == 0)
+	{
+		throw Exception(SDL_GetError());
+	}
+
+	SDL_SetColorKey(_surface, SDL_SRCCOLORKEY, 0);
+
+	_crop.w = 0;
+	_crop.h = 0;
+	_crop.x = 0;
+	_crop.y = 0;
+	_clear.x = 0;
+	_clear.y = 0;
+	_clear.w = getWidth();
+	_clear.h = getHeight();
+}
+
 /**
  * Performs a deep copy of an existing surface.
  * @param other Surface to copy from.
  */
-Surface::Surface(const Surface& other)
+Surface::Surface(const Surface& other) : _ownBuffer(true)
 {
 	//if is native OpenXcom aligned surface
 	if (other._alignedBuffer)
@@ -207,10 +237,42 @@ Surface::Surface(const Surface& other)
  */
 Surface::~Surface()
 {
-	DeleteAligned(_alignedBuffer);
+	if (_ownBuffer)
+		DeleteAligned(_alignedBuffer);
 	SDL_FreeSurface(_surface);
 }
 
+/**
+ * Gets how many bytes the pixels of an 8bpp surface take up,
+ * including the padding that keeps each row aligned.
+ * @param width Width in pixels.
+ * @param height Height in pixels.
+ * @return Size in bytes.
+ */
+int Surface::getBufferSize(int width, int height)
+{
+	return GetPitch(8, width) * height;
+}
+
+/**
+ * Allocates blank aligned pixels for several surfaces to share.
+ * @param size Size in bytes, a sum of getBufferSize() results.
+ * @return Pointer to the pixels.
+ */
+Uint8 *Surface::allocateBuffer(int size)
+{
+	return (Uint8*)NewAligned(8, size, 1);
+}
+
+/**
+ * Frees pixels allocated with allocateBuffer.
+ * @param buffer Pointer to the pixels.
+ */
+void Surface::freeBuffer(Uint8 *buffer)
+{
+	DeleteAligned(buffer);
+}
+
 /**
  * Loads the contents of an X-Com SCR image file into
  * the surface. SCR files are simply uncompressed images
@@ -251,9 +313,11 @@ void Surface::loadScr(const std::string &filename)
 void Surface::loadImage(const std::string &filename)
 {
 	// Destroy current surface (will be replaced)
-	DeleteAligned(_alignedBuffer);
+	if (_ownBuffer)
+		DeleteAligned(_alignedBuffer);
 	SDL_FreeSurface(_surface);
 	_alignedBuffer = 0;
+	_ownBuffer = true;
 	_surface = 0;
 
 	Log(LOG_VERBOSE) << "Loading image: " << filename;
@@ -909,6 +973,39 @@ struct StandardShade
 
 };
 
+namespace helper
+{
+
+/**
+ * Shades whole rows of surface pixels at once for Surface::blitNShade.
+ */
+template<>
+struct draw_row<ColorReplace>
+{
+	template<typename DestType, typename Src0Type, typename Src1Type, typename Src2Type, typename Src3Type>
+	static inline void draw(DestType& dest, Src0Type& src0, Src1Type& src1, Src2Type& src2, Src3Type&, int count)
+	{
+		if (count > 0)
+			PaletteShade::shadeRow(&dest.get_ref(), &src0.get_ref(), count, src1.get_ref(), src2.get_ref());
+	}
+};
+
+/**
+ * Shades whole rows of surface pixels at once for Surface::blitNShade.
+ */
+template<>
+struct draw_row<StandardShade>
+{
+	template<typename DestType, typename Src0Type, typename Src1Type, typename Src2Type, typename Src3Type>
+	static inline void draw(DestType& dest, Src0Type& src0, Src1Type& src1, Src2Type&, Src3Type&, int count)
+	{
+		if (count > 0)
+			PaletteShade::shadeRow(&dest.get_ref(), &src0.get_ref(), count, src1.get_ref());
+	}
+};
+
+}//namespace helper
+
 
 
 /**
@@ -997,9 +1094,11 @@ void Surface::resize(int width, int height)
 	SDL_BlitSurface(_surface, 0, surface, 0);
 
 	// Delete old surface
-	DeleteAligned(_alignedBuffer);
+	if (_ownBuffer)
+		DeleteAligned(_alignedBuffer);
 	SDL_FreeSurface(_surface);
 	_alignedBuffer = alignedBuffer;
+	_ownBuffer = true;
 	_surface = surface;
 
 	_clear.w = getWidth();
@@ -41,16 +41,25 @@ protected:
 	SDL_Rect _crop, _clear;
 	bool _visible, _hidden, _redraw, _tftdMode;
 	void *_alignedBuffer;
+	bool _ownBuffer;
 	std::string _tooltip;
 
 	void resize(int width, int height);
 public:
 	/// Creates a new surface with the specified size and position.
 	Surface(int width, int height, int x = 0, int y = 0, int bpp = 8);
+	/// Creates a new 8bpp surface that draws into pixels owned by someone else.
+	Surface(int width, int height, Uint8 *pixels);
 	/// Creates a new surface from an existing one.
 	Surface(const Surface& other);
 	/// Cleans up the surface.
 	virtual ~Surface();
+	/// Gets how many bytes the pixels of an 8bpp surface take up.
+	static int getBufferSize(int width, int height);
+	/// Allocates pixels for several surfaces to share.
+	static Uint8 *allocateBuffer(int size);
+	/// Frees pixels shared by several surfaces.
+	static void freeBuffer(Uint8 *buffer);
 	/// Loads an X-Com SCR graphic.
 	void loadScr(const std::string &filename);
 	/// Loads an X-Com SPK graphic.
@@ -17,8 +17,10 @@
  * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
  */
 #include "SurfaceSet.h"
-#include <fstream>
+#include <algorithm>
+#include <cstring>
 #include "Surface.h"
+#include "MappedFile.h"
 #include "Exception.h"
 
 namespace OpenXcom
@@ -29,7 +31,7 @@ namespace OpenXcom
  * @param width Frame width in pixels.
  * @param height Frame height in pixels.
  */
-SurfaceSet::SurfaceSet(int width, int height) : _width(width), _height(height)
+SurfaceSet::SurfaceSet(int width, int height) : _width(width), _height(height), _nextPixels(0), _freeFrames(0)
 {
 
 }
@@ -38,14 +40,14 @@ SurfaceSet::SurfaceSet(int width, int height) : _width(width), _height(height)
  * Performs a deep copy of an existing surface set.
  * @param other Surface set to copy from.
  */
-SurfaceSet::SurfaceSet(const SurfaceSet& other)
+SurfaceSet::SurfaceSet(const SurfaceSet& other) : _nextPixels(0), _freeFrames(0)
 {
 	_width = other._width;
 	_height = other._height;
 	
 	for (std::map<int, Surface*>::const_iterator f = other._frames.begin(); f != other._frames.end(); ++f)
 	{
-		_frames[f->first] = new Surface(*f->second);
+		setFrame(f->first, new Surface(*f->second));
 	}
 }
 
@@ -58,6 +60,84 @@ SurfaceSet::~SurfaceSet()
 	{
 		delete i->second;
 	}
+	for (std::vector<Uint8*>::iterator i = _buffers.begin(); i != _buffers.end(); ++i)
+	{
+		Surface::freeBuffer(*i);
+	}
+}
+
+/**
+ * Stores a frame in the set, both in the frame map
+ * and the array used to look frames up quickly.
+ * @param i Frame number in the set.
+ * @param frame Pointer to the frame.
+ */
+void SurfaceSet::setFrame(int i, Surface *frame)
+{
+	_frames[i] = frame;
+	if (i >= 0 && i < MAX_INDEXED_FRAME)
+	{
+		if (i >= (int)_index.size())
+		{
+			_index.resize(i + 1, 0);
+		}
+		_index[i] = frame;
+	}
+}
+
+/**
+ * Allocates a block of pixels that the next frames will be created in.
+ * @param nframes Number of frames the block has room for.
+ */
+void SurfaceSet::reserveFrames(int nframes)
+{
+	int size = Surface::getBufferSize(_width, _height);
+	_nextPixels = Surface::allocateBuffer(size * nframes);
+	_buffers.push_back(_nextPixels);
+	_freeFrames = nframes;
+}
+
+/**
+ * Creates a blank frame using the next free pixels in the current
+ * block, allocating a new block if it's full.
+ * @return Pointer to the new frame.
+ */
+Surface *SurfaceSet::createFrame()
+{
+	int size = Surface::getBufferSize(_width, _height);
+	if (size == 0)
+	{
+		return new Surface(_width, _height);
+	}
+	if (_freeFrames == 0)
+	{
+		reserveFrames(std::max(1, ATLAS_BLOCK_SIZE / size));
+	}
+	Surface *frame = new Surface(_width, _height, _nextPixels);
+	_nextPixels += size;
+	_freeFrames--;
+	return frame;
+}
+
+/**
+ * Creates blank frames that all draw into one block of pixels,
+ * instead of allocating each of them separately.
+ * @param nframes Number of frames.
+ */
+void SurfaceSet::createFrames(int nframes)
+{
+	if (nframes <= 0)
+	{
+		return;
+	}
+	if (Surface::getBufferSize(_width, _height) != 0)
+	{
+		reserveFrames(nframes);
+	}
+	for (int frame = 0; frame < nframes; ++frame)
+	{
+		setFrame(frame, createFrame());
+	}
 }
 
 /**
@@ -76,20 +156,14 @@ void SurfaceSet::loadPck(const std::string &pck, const std::string &tab)
 	// Load TAB and get image offsets
 	if (!tab.empty())
 	{
-		std::ifstream offsetFile(tab.c_str(), std::ios::in | std::ios::binary);
-		if (!offsetFile)
+		MappedFile offsetFile(tab);
+		if (!offsetFile.isOpen())
 		{
 			throw Exception(tab + " not found");
 		}
-		std::streampos begin, end;
-		begin = offsetFile.tellg();
-		int off;
-		offsetFile.read((char*)&off, sizeof(off));
-		offsetFile.seekg(0, std::ios::end);
-		end = offsetFile.tellg();
-		int size = end - begin;
+		int size = offsetFile.size();
 		// 16-bit offsets
-		if (off != 0)
+		if (size >= 4 && (offsetFile.data()[0] | offsetFile.data()[1] | offsetFile.data()[2] | offsetFile.data()[3]) != 0)
 		{
 			nframes = size / 2;
 		}
@@ -98,64 +172,54 @@ void SurfaceSet::loadPck(const std::string &pck, const std::string &tab)
 		{
 			nframes = size / 4;
 		}
-		offsetFile.close();
-		for (int frame = 0; frame < nframes; ++frame)
-		{
-			_frames[frame] = new Surface(_width, _height);
-		}
 	}
 	else
 	{
 		nframes = 1;
-		_frames[0] = new Surface(_width, _height);
 	}
+	createFrames(nframes);
 
 	// Load PCK and put pixels in surfaces
-	std::ifstream imgFile (pck.c_str(), std::ios::in | std::ios::binary);
-	if (!imgFile)
+	MappedFile imgFile(pck);
+	if (!imgFile.isOpen())
 	{
 		throw Exception(pck + " not found");
 	}
 
-	Uint8 value;
-
-	for (int frame = 0; frame < nframes; ++frame)
+	const Uint8 *data = imgFile.data(), *end = data + imgFile.size();
+	for (int frame = 0; frame < nframes && data != end; ++frame)
 	{
-		int x = 0, y = 0;
-
-		// Lock the surface
-		_frames[frame]->lock();
+		SDL_Surface *surface = _frames[frame]->getSurface();
+		Uint8 *pixels = (Uint8*)surface->pixels;
+		// the surface starts out blank, so transparent pixels are just skipped
+		int pos = *data++ * _width;
+		const int total = _width * _height;
 
-		imgFile.read((char*)&value, 1);
-		for (int i = 0; i < value; ++i)
+		while (data != end)
 		{
-			for (int j = 0; j < _width; ++j)
+			Uint8 value = *data++;
+			if (value == 255)
 			{
-				_frames[frame]->setPixelIterative(&x, &y, 0);
+				break;
 			}
-		}
-
-		while (imgFile.read((char*)&value, 1) && value != 255)
-		{
-			if (value == 254)
+			else if (value == 254)
 			{
-				imgFile.read((char*)&value, 1);
-				for (int i = 0; i < value; ++i)
+				if (data == end)
 				{
-					_frames[frame]->setPixelIterative(&x, &y, 0);
+					break;
 				}
+				pos += *data++;
 			}
 			else
 			{
-				_frames[frame]->setPixelIterative(&x, &y, value);
+				if (pos < total)
+				{
+					pixels[(pos / _width) * surface->pitch + pos % _width] = value;
+				}
+				pos++;
 			}
 		}
-
-		// Unlock the surface
-		_frames[frame]->unlock();
 	}
-
-	imgFile.close();
 }
 
 /**
@@ -168,54 +232,25 @@ void SurfaceSet::loadPck(const std::string &pck, const std::string &tab)
  */
 void SurfaceSet::loadDat(const std::string &filename)
 {
-	int nframes = 0;
-
 	// Load file and put pixels in surface
-	std::ifstream imgFile (filename.c_str(), std::ios::in | std::ios::binary);
-	if (!imgFile)
+	MappedFile imgFile(filename);
+	if (!imgFile.isOpen())
 	{
 		throw Exception(filename + " not found");
 	}
 
-	imgFile.seekg(0, std::ios::end);
-	std::streamoff size = imgFile.tellg();
-	imgFile.seekg(0, std::ios::beg);
-
-	nframes = (int)size / (_width * _height);
+	int nframes = (int)imgFile.size() / (_width * _height);
+	createFrames(nframes);
 
-	for (int i = 0; i < nframes; ++i)
-	{
-		Surface *surface = new Surface(_width, _height);
-		_frames[i] = surface;
-	}
-
-	Uint8 value;
-	int x = 0, y = 0, frame = 0;
-
-	// Lock the surface
-	_frames[frame]->lock();
-
-	while (imgFile.read((char*)&value, 1))
+	const Uint8 *data = imgFile.data();
+	for (int frame = 0; frame < nframes; ++frame)
 	{
-		_frames[frame]->setPixelIterative(&x, &y, value);
-
-		if (y >= _height)
+		SDL_Surface *surface = _frames[frame]->getSurface();
+		for (int y = 0; y < _height; ++y, data += _width)
 		{
-			// Unlock the surface
-			_frames[frame]->unlock();
-
-			frame++;
-			x = 0;
-			y = 0;
-
-			if (frame >= nframes)
-				break;
-			else
-				_frames[frame]->lock();
+			memcpy((Uint8*)surface->pixels + y * surface->pitch, data, _width);
 		}
 	}
-
-	imgFile.close();
 }
 
 /**
@@ -225,9 +260,14 @@ void SurfaceSet::loadDat(const std::string &filename)
  */
 Surface *SurfaceSet::getFrame(int i)
 {
-	if (_frames.find(i) != _frames.end())
+	if (i >= 0 && i < MAX_INDEXED_FRAME)
+	{
+		return (i < (int)_index.size()) ? _index[i] : 0;
+	}
+	std::map<int, Surface*>::const_iterator frame = _frames.find(i);
+	if (frame != _frames.end())
 	{
-		return _frames[i];
+		return frame->second;
 	}
 	return 0;
 }
@@ -239,8 +279,9 @@ Surface *SurfaceSet::getFrame(int i)
  */
 Surface *SurfaceSet::addFrame(int i)
 {
-	_frames[i] = new Surface(_width, _height);
-	return _frames[i];
+	Surface *frame = createFrame();
+	setFrame(i, frame);
+	return frame;
 }
 
 /**
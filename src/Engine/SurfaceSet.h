@@ -18,6 +18,7 @@
  * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
  */
 #include <map>
+#include <vector>
 #include <string>
 #include <SDL.h>
 
@@ -31,12 +32,28 @@ class Surface;
  * Used to manage single images that contain series of
  * frames inside, like animated sprites, making them easier
  * to access without constant cropping.
+ * The frames' pixels are kept together in a few big blocks,
+ * and frames are looked up by number in a plain array.
  */
 class SurfaceSet
 {
 private:
+	static const int MAX_INDEXED_FRAME = 8192;
+	static const int ATLAS_BLOCK_SIZE = 65536;
 	int _width, _height;
 	std::map<int, Surface*> _frames;
+	std::vector<Surface*> _index;
+	std::vector<Uint8*> _buffers;
+	Uint8 *_nextPixels;
+	int _freeFrames;
+	/// Stores a frame in the set.
+	void setFrame(int i, Surface *frame);
+	/// Allocates a block of pixels for several frames.
+	void reserveFrames(int nframes);
+	/// Creates a blank frame using pixels from the current block.
+	Surface *createFrame();
+	/// Creates blank frames sharing one block of pixels.
+	void createFrames(int nframes);
 public:
 	/// Crates a surface set with frames of the specified size.
 	SurfaceSet(int width, int height);
@@ -60,6 +77,7 @@ public:
 	size_t getTotalFrames() const;
 	/// Sets the surface set's palette.
 	void setPalette(SDL_Color *colors, int firstcolor = 0, int ncolors = 256);
+	/// Gets all the frames in the set. Don't add or remove frames through it.
 	std::map<int, Surface*> *getFrames();
 };
 
@@ -0,0 +1,150 @@
+/*
+ * Copyright 2010-2016 OpenXcom Developers.
+ *
+ * This file is part of OpenXcom.
+ *
+ * OpenXcom is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenXcom is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "WorkerPool.h"
+
+namespace OpenXcom
+{
+
+/**
+ * Creates a pool of worker threads. The calling thread always
+ * helps out as worker 0, so no threads means jobs simply run
+ * one part after another.
+ * @param threads Number of extra threads.
+ */
+WorkerPool::WorkerPool(int threads) : _job(0), _next(0), _last(0), _pending(0), _quit(false)
+{
+	_mutex = SDL_CreateMutex();
+	_wake = SDL_CreateCond();
+	_finished = SDL_CreateCond();
+	for (int i = 0; i < threads; ++i)
+	{
+		Worker *worker = new Worker;
+		worker->pool = this;
+		worker->number = i + 1;
+		worker->thread = SDL_CreateThread(work, (void*)worker);
+		if (worker->thread == 0)
+		{
+			delete worker;
+			break;
+		}
+		_workers.push_back(worker);
+	}
+}
+
+/**
+ * Stops the worker threads and cleans up.
+ */
+WorkerPool::~WorkerPool()
+{
+	SDL_mutexP(_mutex);
+	_quit = true;
+	SDL_CondBroadcast(_wake);
+	SDL_mutexV(_mutex);
+	for (std::vector<Worker*>::iterator i = _workers.begin(); i != _workers.end(); ++i)
+	{
+		SDL_WaitThread((*i)->thread, 0);
+		delete *i;
+	}
+	SDL_DestroyCond(_finished);
+	SDL_DestroyCond(_wake);
+	SDL_DestroyMutex(_mutex);
+}
+
+/**
+ * Gets the number of threads working on each job, including the calling thread.
+ * @return Number of threads.
+ */
+int WorkerPool::getThreadCount() const
+{
+	return _workers.size() + 1;
+}
+
+/**
+ * Takes parts off the current job until there are none left.
+ * Must be called with the mutex locked.
+ * @param worker Number of the calling thread.
+ * @return True if any parts were worked on.
+ */
+bool WorkerPool::runNext(int worker)
+{
+	bool worked = false;
+	while (_job && _next < _last)
+	{
+		int index = _next++;
+		Job *job = _job;
+		SDL_mutexV(_mutex);
+		job->run(index, worker);
+		SDL_mutexP(_mutex);
+		worked = true;
+		if (--_pending == 0)
+		{
+			SDL_CondSignal(_finished);
+		}
+	}
+	return worked;
+}
+
+/**
+ * Waits for jobs and works on them until the pool is destroyed.
+ * @param data Pointer to the worker.
+ * @return Always 0.
+ */
+int WorkerPool::work(void *data)
+{
+	Worker *worker = (Worker*)data;
+	WorkerPool *pool = worker->pool;
+	SDL_mutexP(pool->_mutex);
+	while (!pool->_quit)
+	{
+		if (!pool->runNext(worker->number))
+		{
+			SDL_CondWait(pool->_wake, pool->_mutex);
+		}
+	}
+	SDL_mutexV(pool->_mutex);
+	return 0;
+}
+
+/**
+ * Runs the parts from first up to (not including) last,
+ * and returns once all of them are done.
+ * @param job The job to run.
+ * @param first Index of the first part.
+ * @param last Index after the last part.
+ */
+void WorkerPool::run(Job *job, int first, int last)
+{
+	if (first >= last)
+		return;
+	SDL_mutexP(_mutex);
+	_job = job;
+	_next = first;
+	_last = last;
+	_pending = last - first;
+	SDL_CondBroadcast(_wake);
+	runNext(0);
+	while (_pending > 0)
+	{
+		SDL_CondWait(_finished, _mutex);
+	}
+	_job = 0;
+	SDL_mutexV(_mutex);
+}
+
+}
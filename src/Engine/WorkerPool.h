@@ -0,0 +1,70 @@
+#pragma once
+/*
+ * Copyright 2010-2016 OpenXcom Developers.
+ *
+ * This file is part of OpenXcom.
+ *
+ * OpenXcom is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenXcom is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <vector>
+#include <SDL.h>
+
+namespace OpenXcom
+{
+
+/**
+ * A pool of worker threads that split a job into independent
+ * pieces and work on them at the same time as the calling thread.
+ */
+class WorkerPool
+{
+public:
+	/// A piece of work split into independent parts.
+	class Job
+	{
+	public:
+		virtual ~Job() {}
+		/// Works on a single part. The worker number is unique among the threads running at the same time.
+		virtual void run(int index, int worker) = 0;
+	};
+private:
+	/// A worker thread.
+	struct Worker
+	{
+		WorkerPool *pool;
+		int number;
+		SDL_Thread *thread;
+	};
+	std::vector<Worker*> _workers;
+	SDL_mutex *_mutex;
+	SDL_cond *_wake, *_finished;
+	Job *_job;
+	int _next, _last, _pending;
+	bool _quit;
+	/// Takes parts off the current job until there are none left.
+	bool runNext(int worker);
+	/// Entry point of the worker threads.
+	static int work(void *data);
+public:
+	/// Creates a pool of worker threads.
+	WorkerPool(int threads);
+	/// Stops the worker threads.
+	~WorkerPool();
+	/// Gets the number of threads working on each job.
+	int getThreadCount() const;
+	/// Runs a range of parts of a job.
+	void run(Job *job, int first, int last);
+};
+
+}
@@ -18,10 +18,13 @@
  */
 
 #include "Zoom.h"
+#include <algorithm>
 
 #include "Surface.h"
 #include "Logger.h"
 #include "Options.h"
+#include "CrossPlatform.h"
+#include "WorkerPool.h"
 #include "Screen.h"
 
 #include "OpenGL.h"
@@ -61,6 +64,212 @@
 namespace OpenXcom
 {
 
+WorkerPool *Zoom::_pool = 0;
+int Zoom::_threads = 0;
+
+/// The scalers that can work on bands of a surface.
+enum ZoomFilter { FILTER_XBRZ, FILTER_HQX, FILTER_SCALE };
+/// Rows of context scaled around a band for filters that don't handle slices themselves.
+static const int BAND_MARGIN = 2;
+/// Bands any smaller aren't worth handing to another thread.
+static const int MIN_BAND_HEIGHT = 16;
+
+static void initHQX()
+{
+	static bool initDone = false;
+
+	if (!initDone)
+	{
+		hqxInit();
+		initDone = true;
+	}
+}
+
+/**
+ * Scales a surface band by band, one band per part.
+ * xBRZ scales slices of the whole picture by itself, the other filters
+ * treat a band as a whole picture, so they get a few more rows of context
+ * on each side, scaled into a buffer of their own, and only the middle
+ * is copied over.
+ */
+class ZoomBandJob : public WorkerPool::Job
+{
+private:
+	int _filter, _factor;
+	SDL_Surface *_src, *_dst;
+	int _first, _last, _bandHeight;
+	std::vector<std::vector<Uint8> > _buffers;
+
+	/// Scales a picture with the chosen filter.
+	void scalePicture(Uint8 *src, int srcPitch, Uint8 *dst, int dstPitch, int height)
+	{
+		if (_filter == FILTER_HQX)
+		{
+			if (_factor == 2) hq2x_32_rb((uint32_t*)src, srcPitch, (uint32_t*)dst, dstPitch, _src->w, height);
+			else if (_factor == 3) hq3x_32_rb((uint32_t*)src, srcPitch, (uint32_t*)dst, dstPitch, _src->w, height);
+			else hq4x_32_rb((uint32_t*)src, srcPitch, (uint32_t*)dst, dstPitch, _src->w, height);
+		}
+		else
+		{
+			scale(_factor, dst, dstPitch, src, srcPitch, _src->format->BytesPerPixel, _src->w, height);
+		}
+	}
+public:
+	ZoomBandJob(int filter, int factor, SDL_Surface *src, SDL_Surface *dst, int first, int last, int bandHeight, int threads) :
+		_filter(filter), _factor(factor), _src(src), _dst(dst), _first(first), _last(last), _bandHeight(bandHeight), _buffers(threads)
+	{
+	}
+	void run(int index, int worker)
+	{
+		int first = _first + index * _bandHeight;
+		int last = std::min(_last, first + _bandHeight);
+		if (_filter == FILTER_XBRZ)
+		{
+			xbrz::scale(_factor, (uint32_t*)_src->pixels, (uint32_t*)_dst->pixels, _src->w, _src->h, xbrz::ScalerCfg(), first, last);
+			return;
+		}
+
+		Uint8 *srcPixels = (Uint8*)_src->pixels;
+		Uint8 *dstPixels = (Uint8*)_dst->pixels;
+		if (first == 0 && last == _src->h)
+		{
+			scalePicture(srcPixels, _src->pitch, dstPixels, _dst->pitch, _src->h);
+			return;
+		}
+		int bandFirst = std::max(0, first - BAND_MARGIN);
+		int bandLast = std::min(_src->h, last + BAND_MARGIN);
+		int rowBytes = _src->w * _factor * _src->format->BytesPerPixel;
+		std::vector<Uint8> &buffer = _buffers[worker];
+		buffer.resize(rowBytes * (bandLast - bandFirst) * _factor);
+		scalePicture(srcPixels + bandFirst * _src->pitch, _src->pitch, &buffer[0], rowBytes, bandLast - bandFirst);
+		for (int y = first * _factor; y < last * _factor; ++y)
+		{
+			memcpy(dstPixels + y * _dst->pitch, &buffer[(y - bandFirst * _factor) * rowBytes], rowBytes);
+		}
+	}
+};
+
+/**
+ * Scales the rows from first up to (not including) last, split into
+ * bands that are scaled at the same time by the threads of the pool.
+ * @param filter The filter to scale with.
+ * @param factor The scaling factor.
+ * @param src The surface to zoom (input).
+ * @param dst The zoomed surface (output).
+ * @param first First source row.
+ * @param last Source row after the last one.
+ * @param pool Threads to use, or 0 to use only the calling thread.
+ */
+void Zoom::scaleRows(int filter, int factor, SDL_Surface *src, SDL_Surface *dst, int first, int last, WorkerPool *pool)
+{
+	int threads = pool ? pool->getThreadCount() : 1;
+	int parts = std::max(1, std::min(threads, (last - first) / MIN_BAND_HEIGHT));
+	int bandHeight = (last - first + parts - 1) / parts;
+	parts = (last - first + bandHeight - 1) / bandHeight;
+	ZoomBandJob job(filter, factor, src, dst, first, last, bandHeight, threads);
+	if (pool && parts > 1)
+	{
+		pool->run(&job, 0, parts);
+	}
+	else
+	{
+		for (int i = 0; i < parts; ++i)
+		{
+			job.run(i, 0);
+		}
+	}
+}
+
+/**
+ * Gets the worker threads to scale some rows with. The threads are
+ * only started the first time a scaler has enough rows to split them
+ * into more than one band, so nothing runs for players who never use
+ * a software filter.
+ * @param rows Number of source rows to scale.
+ * @return Threads to use, or 0 to use only the calling thread.
+ */
+WorkerPool *Zoom::getPool(int rows)
+{
+	if (_threads == 0 || rows < 2 * MIN_BAND_HEIGHT)
+	{
+		return 0;
+	}
+	if (!_pool)
+	{
+		_pool = new WorkerPool(_threads);
+	}
+	return _pool;
+}
+
+/**
+ * Sets the number of worker threads of the software scalers.
+ * The threads themselves are started when first needed.
+ * @param threads Number of extra threads, 0 to scale on the calling thread only.
+ */
+void Zoom::setThreads(int threads)
+{
+	threads = std::max(0, threads);
+	if (_threads == threads)
+	{
+		return;
+	}
+	_threads = threads;
+	delete _pool;
+	_pool = 0;
+}
+
+/**
+ * Scales a test picture with every software scaler and factor, using
+ * different numbers of threads, and logs the time taken per frame.
+ * @param width Width of the picture, like the game's base resolution.
+ * @param height Height of the picture.
+ */
+void Zoom::benchmark(int width, int height)
+{
+	const int frames = 10;
+	const int threadCounts[] = {1, 2, 4, 8};
+	const char *names[] = {"xBRZ", "HQX", "Scale"};
+	const int maxFactor[] = {5, 4, 4};
+
+	initHQX();
+	SDL_Surface *src32 = SDL_CreateRGBSurface(SDL_SWSURFACE, width, height, 32, 0xff0000, 0x00ff00, 0x0000ff, 0);
+	SDL_Surface *src8 = SDL_CreateRGBSurface(SDL_SWSURFACE, width, height, 8, 0, 0, 0, 0);
+	// something with plenty of edges for the filters to work on
+	for (int y = 0; y < height; ++y)
+	{
+		for (int x = 0; x < width; ++x)
+		{
+			Uint8 color = (Uint8)((x / 3) ^ (y / 5) ^ (x * y / 7));
+			((Uint32*)((Uint8*)src32->pixels + y * src32->pitch))[x] = color * 0x010101;
+			((Uint8*)src8->pixels)[y * src8->pitch + x] = color;
+		}
+	}
+
+	for (int filter = FILTER_XBRZ; filter <= FILTER_SCALE; ++filter)
+	{
+		SDL_Surface *src = filter == FILTER_SCALE ? src8 : src32;
+		for (int factor = 2; factor <= maxFactor[filter]; ++factor)
+		{
+			SDL_Surface *dst = SDL_CreateRGBSurface(SDL_SWSURFACE, width * factor, height * factor, src->format->BitsPerPixel, 0, 0, 0, 0);
+			for (size_t i = 0; i < sizeof(threadCounts) / sizeof(threadCounts[0]); ++i)
+			{
+				WorkerPool *pool = threadCounts[i] > 1 ? new WorkerPool(threadCounts[i] - 1) : 0;
+				Uint64 start = CrossPlatform::getMicroseconds();
+				for (int frame = 0; frame < frames; ++frame)
+				{
+					scaleRows(filter, factor, src, dst, 0, height, pool);
+				}
+				double time = (CrossPlatform::getMicroseconds() - start) / 1000.0 / frames;
+				Log(LOG_INFO) << names[filter] << " " << factor << "x at " << dst->w << "x" << dst->h << ", " << threadCounts[i] << " threads: " << time << " ms/frame";
+				delete pool;
+			}
+			SDL_FreeSurface(dst);
+		}
+	}
+	SDL_FreeSurface(src8);
+	SDL_FreeSurface(src32);
+}
+
 
 /**
  * Optimized 8-bit zoomer for resizing by a factor of 2. Doesn't flip.
@@ -697,6 +906,37 @@ void Zoom::flipWithZoom(SDL_Surface *src, SDL_Surface *dst, int topBlackBand, in
 }
 
 
+/**
+ * Scales a band of rows of the source surface onto the destination,
+ * so unchanged parts of the screen don't have to be scaled again.
+ * Only xBRZ without black bands can scale part of a picture, since it
+ * takes the surrounding rows into account by itself.
+ * @param src The surface to zoom (input).
+ * @param dst The zoomed surface (output).
+ * @param top First source row that changed, returns the first row scaled.
+ * @param bottom Row after the last source row that changed, returns the row after the last one scaled.
+ * @return True if the rows were scaled, false if the whole surface needs to be.
+ */
+bool Zoom::zoomRows(SDL_Surface *src, SDL_Surface *dst, int *top, int *bottom)
+{
+	if (!Screen::is32bitEnabled() || !Options::useXBRZFilter || Screen::isOpenGLEnabled())
+	{
+		return false;
+	}
+	for (int factor = 2; factor <= 5; factor++)
+	{
+		if (dst->w == src->w * factor && dst->h == src->h * factor)
+		{
+			// a changed pixel affects the scaled pixels of the rows around it
+			*top = std::max(0, *top - 3);
+			*bottom = std::min(src->h, *bottom + 3);
+			scaleRows(FILTER_XBRZ, factor, src, dst, *top, *bottom, getPool(*bottom - *top));
+			return true;
+		}
+	}
+	return false;
+}
+
 /**
  * Internal 8-bit Zoomer without smoothing.
  * Source code originally from SDL_gfx (LGPL) with permission by author.
@@ -730,7 +970,7 @@ int Zoom::_zoomSurfaceY(SDL_Surface * src, SDL_Surface * dst, int flipx, int fli
 			{
 				if (dst->w == src->w * (int)factor && dst->h == src->h * (int)factor)
 				{
-					xbrz::scale(factor, (uint32_t*)src->pixels, (uint32_t*)dst->pixels, src->w, src->h);
+					scaleRows(FILTER_XBRZ, factor, src, dst, 0, src->h, getPool(src->h));
 					return 0;
 				}
 			}
@@ -738,32 +978,17 @@ int Zoom::_zoomSurfaceY(SDL_Surface * src, SDL_Surface * dst, int flipx, int fli
 
 		if (Options::useHQXFilter)
 		{
-			static bool initDone = false;
-
-			if (!initDone)
-			{
-				hqxInit();
-				initDone = true;
-			}
+			initHQX();
 
 			// HQX_API void HQX_CALLCONV hq2x_32_rb( uint32_t * src, uint32_t src_rowBytes, uint32_t * dest, uint32_t dest_rowBytes, int width, int height );
 
-			if (dst->w == src->w * 2 && dst->h == src->h * 2)
+			for (int factor = 2; factor <= 4; factor++)
 			{
-				hq2x_32_rb((uint32_t*)src->pixels, src->pitch, (uint32_t*)dst->pixels, dst->pitch, src->w, src->h);
-				return 0;
-			}
-
-			if (dst->w == src->w * 3 && dst->h == src->h * 3)
-			{
-				hq3x_32_rb((uint32_t*)src->pixels, src->pitch, (uint32_t*)dst->pixels, dst->pitch, src->w, src->h);
-				return 0;
-			}
-
-			if (dst->w == src->w * 4 && dst->h == src->h * 4)
-			{
-				hq4x_32_rb((uint32_t*)src->pixels, src->pitch, (uint32_t*)dst->pixels, dst->pitch, src->w, src->h);
-				return 0;
+				if (dst->w == src->w * factor && dst->h == src->h * factor)
+				{
+					scaleRows(FILTER_HQX, factor, src, dst, 0, src->h, getPool(src->h));
+					return 0;
+				}
 			}
 		}
 	}
@@ -775,7 +1000,7 @@ int Zoom::_zoomSurfaceY(SDL_Surface * src, SDL_Surface * dst, int flipx, int fli
 		{
 			if (dst->w == src->w * (int)factor && dst->h == src->h * (int)factor && !scale_precondition(factor, src->format->BytesPerPixel, src->w, src->h))
 			{
-				scale(factor, dst->pixels, dst->pitch, src->pixels, src->pitch, src->format->BytesPerPixel, src->w, src->h);
+				scaleRows(FILTER_SCALE, factor, src, dst, 0, src->h, getPool(src->h));
 				return 0;
 			}
 		}
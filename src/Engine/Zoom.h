@@ -23,20 +23,32 @@
 namespace OpenXcom
 {
 
+class WorkerPool;
 
 class Zoom
 {
 
 	public:
+	/// Sets the number of extra threads the software scalers use.
+	static void setThreads(int threads);
+	/// Logs how long each software scaler takes per frame with different numbers of threads.
+	static void benchmark(int width, int height);
 	/// Flip screen given src and dst; might use software or OpenGL.
 	static void flipWithZoom(SDL_Surface *src, SDL_Surface *dst, int topBlackBand, int bottomBlackBand, int leftBlackBand, int rightBlackBand, OpenGL *glOut);
+	/// Scales only some rows of src to dst, if the scaler in use allows it.
+	static bool zoomRows(SDL_Surface *src, SDL_Surface *dst, int *top, int *bottom);
 	/// Copy src to dst, resizing as needed. Please don't use flipx or flipy as the optimized functions ignore these parameters.
 	static int _zoomSurfaceY(SDL_Surface * src, SDL_Surface * dst, int flipx, int flipy);
 	/// Check for SSE2 instructions using CPUID.
 	static bool haveSSE2();
 
 private:
-
+	static WorkerPool *_pool;
+	static int _threads;
+	/// Gets the worker threads for scaling some rows, starting them if needed.
+	static WorkerPool *getPool(int rows);
+	/// Scales a range of rows with one of the filters, split into bands over the worker threads.
+	static void scaleRows(int filter, int factor, SDL_Surface *src, SDL_Surface *dst, int first, int last, WorkerPool *pool);
 };
 
 }
@@ -1080,21 +1080,13 @@ void DogfightState::update()
 			{
 				if (_ufo->getShotDownByCraftId() == _craft->getUniqueId())
 				{
-					for (std::vector<Country*>::iterator country = _game->getSavedGame()->getCountries()->begin(); country != _game->getSavedGame()->getCountries()->end(); ++country)
+					if (Country *country = _game->getSavedGame()->locateCountry(*_ufo))
 					{
-						if ((*country)->getRules()->insideCountry(_ufo->getLongitude(), _ufo->getLatitude()))
-						{
-							(*country)->addActivityXcom(_ufo->getRules()->getScore()*2);
-							break;
-						}
+						country->addActivityXcom(_ufo->getRules()->getScore()*2);
 					}
-					for (std::vector<Region*>::iterator region = _game->getSavedGame()->getRegions()->begin(); region != _game->getSavedGame()->getRegions()->end(); ++region)
+					if (Region *region = _game->getSavedGame()->locateRegion(*_ufo))
 					{
-						if ((*region)->getRules()->insideRegion(_ufo->getLongitude(), _ufo->getLatitude()))
-						{
-							(*region)->addActivityXcom(_ufo->getRules()->getScore()*2);
-							break;
-						}
+						region->addActivityXcom(_ufo->getRules()->getScore()*2);
 					}
 					setStatus("STR_UFO_DESTROYED");
 					_game->getMod()->getSound("GEO.CAT", Mod::UFO_EXPLODE)->play(); //11
@@ -1107,21 +1099,13 @@ void DogfightState::update()
 				{
 					setStatus("STR_UFO_CRASH_LANDS");
 					_game->getMod()->getSound("GEO.CAT", Mod::UFO_CRASH)->play(); //10
-					for (std::vector<Country*>::iterator country = _game->getSavedGame()->getCountries()->begin(); country != _game->getSavedGame()->getCountries()->end(); ++country)
+					if (Country *country = _game->getSavedGame()->locateCountry(*_ufo))
 					{
-						if ((*country)->getRules()->insideCountry(_ufo->getLongitude(), _ufo->getLatitude()))
-						{
-							(*country)->addActivityXcom(_ufo->getRules()->getScore());
-							break;
-						}
+						country->addActivityXcom(_ufo->getRules()->getScore());
 					}
-					for (std::vector<Region*>::iterator region = _game->getSavedGame()->getRegions()->begin(); region != _game->getSavedGame()->getRegions()->end(); ++region)
+					if (Region *region = _game->getSavedGame()->locateRegion(*_ufo))
 					{
-						if ((*region)->getRules()->insideRegion(_ufo->getLongitude(), _ufo->getLatitude()))
-						{
-							(*region)->addActivityXcom(_ufo->getRules()->getScore());
-							break;
-						}
+						region->addActivityXcom(_ufo->getRules()->getScore());
 					}
 				}
 				if (!_state->getGlobe()->insideLand(_ufo->getLongitude(), _ufo->getLatitude()))
@@ -44,6 +44,7 @@
 #include "../Mod/RuleUfo.h"
 #include "../Mod/RuleMissionScript.h"
 #include "../Savegame/Waypoint.h"
+#include "../Savegame/RadarGrid.h"
 #include "../Savegame/Transfer.h"
 #include "../Savegame/Soldier.h"
 #include "../Savegame/SoldierDiary.h"
@@ -626,6 +627,8 @@ void GeoscapeState::timeDisplay()
  * the timer until the next speed step (eg. the next day
  * on 1 Day speed) or until an event occurs, since updating
  * the screen on each step would become cumbersomely slow.
+ * Stretches of steps where nothing can happen but movement
+ * are run through quickly, up to the next event.
  */
 void GeoscapeState::timeAdvance()
 {
@@ -657,6 +660,13 @@ void GeoscapeState::timeAdvance()
 
 	for (int i = 0; i < timeSpan && !_pause; ++i)
 	{
+		int quiet = std::min(timeSpan - i, getQuietSteps());
+		if (quiet > 0)
+		{
+			advanceQuietSteps(quiet);
+			i += quiet - 1;
+			continue;
+		}
 		TimeTrigger trigger;
 		trigger = _game->getSavedGame()->getTime()->advance();
 		switch (trigger)
@@ -785,21 +795,13 @@ void GeoscapeState::time5Seconds()
 		{
 			if ((*j)->isDestroyed())
 			{
-				for (std::vector<Country*>::iterator country = _game->getSavedGame()->getCountries()->begin(); country != _game->getSavedGame()->getCountries()->end(); ++country)
+				if (Country *country = _game->getSavedGame()->locateCountry(**j))
 				{
-					if ((*country)->getRules()->insideCountry((*j)->getLongitude(), (*j)->getLatitude()))
-					{
-						(*country)->addActivityXcom(-(*j)->getRules()->getScore());
-						break;
-					}
+					country->addActivityXcom(-(*j)->getRules()->getScore());
 				}
-				for (std::vector<Region*>::iterator region = _game->getSavedGame()->getRegions()->begin(); region != _game->getSavedGame()->getRegions()->end(); ++region)
+				if (Region *region = _game->getSavedGame()->locateRegion(**j))
 				{
-					if ((*region)->getRules()->insideRegion((*j)->getLongitude(), (*j)->getLatitude()))
-					{
-						(*region)->addActivityXcom(-(*j)->getRules()->getScore());
-						break;
-					}
+					region->addActivityXcom(-(*j)->getRules()->getScore());
 				}
 				// if a transport craft has been shot down, kill all the soldiers on board.
 				if ((*j)->getRules()->getSoldiers() > 0)
@@ -1015,6 +1017,151 @@ void GeoscapeState::time5Seconds()
 	}
 }
 
+/**
+ * Works out how many of the next 5 second steps are sure to do
+ * nothing but move things around, ie. until the next time trigger,
+ * UFO countdown running out, or craft or UFO that could reach
+ * its destination. Anything already needing attention stops it.
+ * @return Number of steps, 0 if the next one has events.
+ */
+int GeoscapeState::getQuietSteps() const
+{
+	SavedGame *save = _game->getSavedGame();
+	if (save->getBases()->empty() || save->getEnding() == END_LOSE)
+	{
+		return 0;
+	}
+	bool zooming = _zoomInEffectTimer->isRunning() || _zoomOutEffectTimer->isRunning();
+	int steps = save->getTime()->getAdvancesToTrigger() - 1;
+
+	for (std::vector<Ufo*>::const_iterator i = save->getUfos()->begin(); i != save->getUfos()->end() && steps > 0; ++i)
+	{
+		switch ((*i)->getStatus())
+		{
+		case Ufo::FLYING:
+			if (!zooming)
+			{
+				steps = std::min(steps, (*i)->getMovesToDestination());
+			}
+			break;
+		case Ufo::LANDED:
+			steps = std::min(steps, (int)((*i)->getSecondsRemaining() / 5) - 1);
+			break;
+		case Ufo::CRASHED:
+			if ((*i)->getSecondsRemaining() == 0)
+			{
+				steps = 0;
+			}
+			break;
+		case Ufo::DESTROYED:
+			steps = 0;
+			break;
+		}
+	}
+	for (std::vector<Base*>::const_iterator i = save->getBases()->begin(); i != save->getBases()->end() && steps > 0; ++i)
+	{
+		for (std::vector<Craft*>::const_iterator j = (*i)->getCrafts()->begin(); j != (*i)->getCrafts()->end() && steps > 0; ++j)
+		{
+			if ((*j)->isDestroyed())
+			{
+				steps = 0;
+			}
+			else if ((*j)->getDestination() != 0)
+			{
+				Ufo *u = dynamic_cast<Ufo*>((*j)->getDestination());
+				if ((*j)->isInDogfight() || (u != 0 && (!u->getDetected() || u->getStatus() == Ufo::DESTROYED)))
+				{
+					steps = 0;
+				}
+				else if (zooming)
+				{
+					if ((*j)->reachedDestination())
+					{
+						steps = 0;
+					}
+				}
+				else
+				{
+					steps = std::min(steps, (*j)->getMovesToDestination());
+				}
+			}
+		}
+	}
+	for (std::vector<Waypoint*>::const_iterator i = save->getWaypoints()->begin(); i != save->getWaypoints()->end() && steps > 0; ++i)
+	{
+		if ((*i)->getFollowers()->empty())
+		{
+			steps = 0;
+		}
+	}
+	return std::max(steps, 0);
+}
+
+/**
+ * Runs through 5 second steps that are known to have no events,
+ * doing only the movement and countdowns that time5Seconds() would.
+ * Things that aren't moving are only updated once.
+ * @param steps Number of steps, from getQuietSteps().
+ */
+void GeoscapeState::advanceQuietSteps(int steps)
+{
+	SavedGame *save = _game->getSavedGame();
+	bool zooming = _zoomInEffectTimer->isRunning() || _zoomOutEffectTimer->isRunning();
+	std::vector<Ufo*> ufos;
+	std::vector<Craft*> crafts;
+
+	for (std::vector<Ufo*>::iterator i = save->getUfos()->begin(); i != save->getUfos()->end(); ++i)
+	{
+		switch ((*i)->getStatus())
+		{
+		case Ufo::FLYING:
+			if (!zooming)
+			{
+				ufos.push_back(*i);
+			}
+			break;
+		case Ufo::LANDED:
+			(*i)->setSecondsRemaining((*i)->getSecondsRemaining() - steps * 5);
+			break;
+		case Ufo::CRASHED:
+			(*i)->think();
+			break;
+		case Ufo::DESTROYED:
+			break;
+		}
+	}
+	if (!zooming)
+	{
+		for (std::vector<Base*>::iterator i = save->getBases()->begin(); i != save->getBases()->end(); ++i)
+		{
+			for (std::vector<Craft*>::iterator j = (*i)->getCrafts()->begin(); j != (*i)->getCrafts()->end(); ++j)
+			{
+				if ((*j)->getDestination() == 0 && !(*j)->isTakingOff())
+				{
+					(*j)->think();
+				}
+				else
+				{
+					crafts.push_back(*j);
+				}
+			}
+		}
+	}
+
+	for (int i = 0; i < steps; ++i)
+	{
+		save->getTime()->advance();
+		for (std::vector<Ufo*>::iterator j = ufos.begin(); j != ufos.end(); ++j)
+		{
+			(*j)->think();
+		}
+		for (std::vector<Craft*>::iterator j = crafts.begin(); j != crafts.end(); ++j)
+		{
+			(*j)->think();
+		}
+	}
+}
+
 /**
  * Functor that attempt to detect an XCOM base.
  */
@@ -1171,13 +1318,9 @@ bool GeoscapeState::processMissionSite(MissionSite *site) const
 	{
 		region->addActivityAlien(score);
 	}
-	for (std::vector<Country*>::iterator k = _game->getSavedGame()->getCountries()->begin(); k != _game->getSavedGame()->getCountries()->end(); ++k)
+	if (Country *country = _game->getSavedGame()->locateCountry(*site))
 	{
-		if ((*k)->getRules()->insideCountry(site->getLongitude(), site->getLatitude()))
-		{
-			(*k)->addActivityAlien(score);
-			break;
-		}
+		country->addActivityAlien(score);
 	}
 	if (!removeSite)
 	{
@@ -1281,6 +1424,7 @@ void GeoscapeState::time30Minutes()
 	}
 
 	// Handle UFO detection and give aliens points
+	RadarGrid radars(*_game->getSavedGame()->getBases());
 	for (std::vector<Ufo*>::iterator u = _game->getSavedGame()->getUfos()->begin(); u != _game->getSavedGame()->getUfos()->end(); ++u)
 	{
 		int points = (*u)->getRules()->getMissionScore(); //one point per UFO in-flight per half hour
@@ -1290,44 +1434,36 @@ void GeoscapeState::time30Minutes()
 			points *= 2;
 		case Ufo::FLYING:
 			// Get area
-			for (std::vector<Region*>::iterator k = _game->getSavedGame()->getRegions()->begin(); k != _game->getSavedGame()->getRegions()->end(); ++k)
+			if (Region *region = _game->getSavedGame()->locateRegion(**u))
 			{
-				if ((*k)->getRules()->insideRegion((*u)->getLongitude(), (*u)->getLatitude()))
-				{
-					(*k)->addActivityAlien(points);
-					break;
-				}
+				region->addActivityAlien(points);
 			}
 			// Get country
-			for (std::vector<Country*>::iterator k = _game->getSavedGame()->getCountries()->begin(); k != _game->getSavedGame()->getCountries()->end(); ++k)
+			if (Country *country = _game->getSavedGame()->locateCountry(**u))
 			{
-				if ((*k)->getRules()->insideCountry((*u)->getLongitude(), (*u)->getLatitude()))
-				{
-					(*k)->addActivityAlien(points);
-					break;
-				}
+				country->addActivityAlien(points);
 			}
 			if (!(*u)->getDetected())
 			{
 				bool detected = false, hyperdetected = false;
-				for (std::vector<Base*>::iterator b = _game->getSavedGame()->getBases()->begin(); !hyperdetected && b != _game->getSavedGame()->getBases()->end(); ++b)
+				const std::vector<RadarGrid::Radar> &candidates = radars.getRadars(*u);
+				for (std::vector<RadarGrid::Radar>::const_iterator r = candidates.begin(); !hyperdetected && r != candidates.end(); ++r)
 				{
-					switch ((*b)->detect(*u))
+					if (r->craft == 0)
 					{
-					case 2:	// hyper-wave decoder
-						(*u)->setHyperDetected(true);
-						hyperdetected = true;
-					case 1: // conventional radar
-						detected = true;
-					}
-					for (std::vector<Craft*>::iterator c = (*b)->getCrafts()->begin(); !detected && c != (*b)->getCrafts()->end(); ++c)
-					{
-						if ((*c)->getStatus() == "STR_OUT" && (*c)->detect(*u))
+						switch (r->base->detect(*u))
 						{
+						case 2:	// hyper-wave decoder
+							(*u)->setHyperDetected(true);
+							hyperdetected = true;
+						case 1: // conventional radar
 							detected = true;
-							break;
 						}
 					}
+					else if (!detected && r->craft->detect(*u))
+					{
+						detected = true;
+					}
 				}
 				if (detected)
 				{
@@ -1338,28 +1474,28 @@ void GeoscapeState::time30Minutes()
 			else
 			{
 				bool detected = false, hyperdetected = false;
-				for (std::vector<Base*>::iterator b = _game->getSavedGame()->getBases()->begin(); !hyperdetected && b != _game->getSavedGame()->getBases()->end(); ++b)
+				const std::vector<RadarGrid::Radar> &candidates = radars.getRadars(*u);
+				for (std::vector<RadarGrid::Radar>::const_iterator r = candidates.begin(); !hyperdetected && r != candidates.end(); ++r)
 				{
-					switch ((*b)->insideRadarRange(*u))
+					if (r->craft == 0)
 					{
-					case 2:	// hyper-wave decoder
-						detected = true;
-						hyperdetected = true;
-						(*u)->setHyperDetected(true);
-						break;
-					case 1: // conventional radar
-						detected = true;
-						hyperdetected = (*u)->getHyperDetected();
-					}
-					for (std::vector<Craft*>::iterator c = (*b)->getCrafts()->begin(); !detected && c != (*b)->getCrafts()->end(); ++c)
-					{
-						if ((*c)->getStatus() == "STR_OUT" && (*c)->insideRadarRange(*u))
+						switch (r->base->insideRadarRange(*u))
 						{
+						case 2:	// hyper-wave decoder
 							detected = true;
-							hyperdetected = (*u)->getHyperDetected();
+							hyperdetected = true;
+							(*u)->setHyperDetected(true);
 							break;
+						case 1: // conventional radar
+							detected = true;
+							hyperdetected = (*u)->getHyperDetected();
 						}
 					}
+					else if (!detected && r->craft->insideRadarRange(*u))
+					{
+						detected = true;
+						hyperdetected = (*u)->getHyperDetected();
+					}
 				}
 				if (!detected)
 				{
@@ -1670,21 +1806,13 @@ void GeoscapeState::time1Day()
 	// handle regional and country points for alien bases
 	for (std::vector<AlienBase*>::const_iterator b = _game->getSavedGame()->getAlienBases()->begin(); b != _game->getSavedGame()->getAlienBases()->end(); ++b)
 	{
-		for (std::vector<Region*>::iterator k = _game->getSavedGame()->getRegions()->begin(); k != _game->getSavedGame()->getRegions()->end(); ++k)
+		if (Region *region = _game->getSavedGame()->locateRegion(**b))
 		{
-			if ((*k)->getRules()->insideRegion((*b)->getLongitude(), (*b)->getLatitude()))
-			{
-				(*k)->addActivityAlien((*b)->getDeployment()->getPoints());
-				break;
-			}
+			region->addActivityAlien((*b)->getDeployment()->getPoints());
 		}
-		for (std::vector<Country*>::iterator k = _game->getSavedGame()->getCountries()->begin(); k != _game->getSavedGame()->getCountries()->end(); ++k)
+		if (Country *country = _game->getSavedGame()->locateCountry(**b))
 		{
-			if ((*k)->getRules()->insideCountry((*b)->getLongitude(), (*b)->getLatitude()))
-			{
-				(*k)->addActivityAlien((*b)->getDeployment()->getPoints());
-				break;
-			}
+			country->addActivityAlien((*b)->getDeployment()->getPoints());
 		}
 	}
 
@@ -73,6 +73,10 @@ public:
 	void timeAdvance();
 	/// Trigger whenever 5 seconds pass.
 	void time5Seconds();
+	/// Gets how many 5 seconds steps are sure to pass without events.
+	int getQuietSteps() const;
+	/// Runs through 5 seconds steps without events.
+	void advanceQuietSteps(int steps);
 	/// Trigger whenever 10 minutes pass.
 	void time10Minutes();
 	/// Trigger whenever 30 minutes pass.
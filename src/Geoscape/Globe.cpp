@@ -59,6 +59,7 @@ namespace OpenXcom
 
 const double Globe::ROTATE_LONGITUDE = 0.10;
 const double Globe::ROTATE_LATITUDE = 0.06;
+const double Globe::SHADOW_TOLERANCE = 0.002;
 
 Uint8 Globe::OCEAN_COLOR;
 Uint8 Globe::COUNTRY_LABEL_COLOR;
@@ -232,10 +233,10 @@ struct CreateShadow
 		}
 	}
 
-	static inline void func(Uint8& dest, const Cord& earth, const Cord& sun, const Sint16& noise, const int&)
+	static inline void func(Uint8& dest, const Uint8& land, const Cord& earth, const Cord& sun, const Sint16& noise)
 	{
-		if (dest && earth.z)
-			dest = getShadowValue(dest, earth, sun, noise);
+		if (land && earth.z)
+			dest = getShadowValue(land, earth, sun, noise);
 		else
 			dest = 0;
 	}
@@ -254,7 +255,7 @@ struct CreateShadow
  * @param x X position in pixels.
  * @param y Y position in pixels.
  */
-Globe::Globe(Game* game, int cenX, int cenY, int width, int height, int x, int y) : InteractiveSurface(width, height, x, y), _rotLon(0.0), _rotLat(0.0), _hoverLon(0.0), _hoverLat(0.0), _cenX(cenX), _cenY(cenY), _game(game), _hover(false), _blink(-1),
+Globe::Globe(Game* game, int cenX, int cenY, int width, int height, int x, int y) : InteractiveSurface(width, height, x, y), _rotLon(0.0), _rotLat(0.0), _hoverLon(0.0), _hoverLat(0.0), _cenX(cenX), _cenY(cenY), _game(game), _landLon(0.0), _landLat(0.0), _landRadius(0.0), _landZoom(0), _hover(false), _blink(-1),
 																					_isMouseScrolling(false), _isMouseScrolled(false), _xBeforeMouseScrolling(0), _yBeforeMouseScrolling(0), _lonBeforeMouseScrolling(0.0), _latBeforeMouseScrolling(0.0), _mouseScrollingStartTime(0), _totalMouseMoveX(0), _totalMouseMoveY(0), _mouseMovedOverThreshold(false)
 {
 	_rules = game->getMod()->getGlobe();
@@ -264,6 +265,7 @@ Globe::Globe(Game* game, int cenX, int cenY, int width, int height, int x, int y
 	_countries = new Surface(width, height, x, y);
 	_markers = new Surface(width, height, x, y);
 	_radars = new Surface(width, height, x, y);
+	_land = new Surface(width, height, x, y);
 	_clipper = new FastLineClip(x, x+width, y, y+height);
 
 	// Animation timers
@@ -298,6 +300,7 @@ Globe::~Globe()
 	delete _rotTimer;
 	delete _countries;
 	delete _markers;
+	delete _land;
 	delete _texture;
 	delete _markerSet;
 	delete _radars;
@@ -400,7 +403,8 @@ Polygon* Globe::getPolygonFromLonLat(double lon, double lat) const
 	double coslat = cos(lat);
 	double sinlat = sin(lat);
 
-	for (std::list<Polygon*>::iterator i = _rules->getPolygons()->begin(); i != _rules->getPolygons()->end(); ++i)
+	const std::vector<Polygon*> &polygons = _rules->getPolygonsAt(lon, lat);
+	for (std::vector<Polygon*>::const_iterator i = polygons.begin(); i != polygons.end(); ++i)
 	{
 		double x, y, z, x2, y2;
 		double clat, clon;
@@ -831,6 +835,7 @@ void Globe::setPalette(SDL_Color *colors, int firstcolor, int ncolors)
 	_countries->setPalette(colors, firstcolor, ncolors);
 	_markers->setPalette(colors, firstcolor, ncolors);
 	_radars->setPalette(colors, firstcolor, ncolors);
+	_land->setPalette(colors, firstcolor, ncolors);
 }
 
 /**
@@ -874,19 +879,37 @@ void Globe::rotate()
 
 /**
  * Draws the whole globe, part by part.
+ * The unshaded ocean and land are kept in a separate
+ * surface and only drawn again when the globe is moved
+ * or zoomed, and the sun shading is only applied again
+ * when the globe is moved or the sun has moved enough
+ * to make a visible difference.
  */
 void Globe::draw()
 {
-	if (_redraw)
+	bool moved = _redraw || _landLon != _cenLon || _landLat != _cenLat || _landRadius != _radius || _landZoom != _zoom;
+	Cord sun = getSunDirection(_cenLon, _cenLat);
+	Cord sunMoved = sun;
+	sunMoved -= _shadowSun;
+	if (moved)
 	{
 		cachePolygons();
+		_land->clear();
+		drawOcean();
+		drawLand();
+		_landLon = _cenLon;
+		_landLat = _cenLat;
+		_landRadius = _radius;
+		_landZoom = _zoom;
 	}
-	Surface::draw();
-	drawOcean();
-	drawLand();
 	drawRadars();
 	drawFlights();
-	drawShadow();
+	if (moved || sunMoved.norm() > SHADOW_TOLERANCE)
+	{
+		_shadowSun = sun;
+		Surface::draw();
+		drawShadow();
+	}
 	drawMarkers();
 	drawDetail();
 }
@@ -897,10 +920,10 @@ void Globe::draw()
  */
 void Globe::drawOcean()
 {
-	lock();
-	drawCircle(_cenX+1, _cenY, _radius+20, OCEAN_COLOR);
-//	ShaderDraw<Ocean>(ShaderSurface(this));
-	unlock();
+	_land->lock();
+	_land->drawCircle(_cenX+1, _cenY, _radius+20, OCEAN_COLOR);
+//	ShaderDraw<Ocean>(ShaderSurface(_land));
+	_land->unlock();
 }
 
 
@@ -924,7 +947,7 @@ void Globe::drawLand()
 		}
 
 		// Apply textures according to zoom and shade
-		drawTexturedPolygon(x, y, (*i)->getPoints(), _texture->getFrame((*i)->getTexture() + _zoomTexture), 0, 0);
+		_land->drawTexturedPolygon(x, y, (*i)->getPoints(), _texture->getFrame((*i)->getTexture() + _zoomTexture), 0, 0);
 	}
 }
 
@@ -984,6 +1007,10 @@ Cord Globe::getSunDirection(double lon, double lat) const
 }
 
 
+/**
+ * Renders the cached ocean and land onto the globe,
+ * shading them according to the last sun direction.
+ */
 void Globe::drawShadow()
 {
 	ShaderMove<Cord> earth = ShaderMove<Cord>(_earthData[_zoom], getWidth(), getHeight());
@@ -992,7 +1019,9 @@ void Globe::drawShadow()
 	earth.setMove(_cenX-getWidth()/2, _cenY-getHeight()/2);
 
 	lock();
-	ShaderDraw<CreateShadow>(ShaderSurface(this), earth, ShaderScalar(getSunDirection(_cenLon, _cenLat)), noise);
+	_land->lock();
+	ShaderDraw<CreateShadow>(ShaderSurface(this), ShaderSurface(_land), earth, ShaderScalar(_shadowSun), noise);
+	_land->unlock();
 	unlock();
 
 }
@@ -1160,7 +1189,7 @@ void Globe::drawGlobeCircle(double lat, double lon, double radius, int segments)
 			continue;
 		}
 		if (!pointBack(lon1,lat1))
-			XuLine(_radars, this, x, y, x2, y2, 6);
+			XuLine(_radars, _land, x, y, x2, y2, 6);
 		x2=x; y2=y;
 	}
 }
@@ -1448,7 +1477,7 @@ void Globe::drawPath(Surface *surface, double lon1, double lat1, double lon2, do
 
 		if (!pointBack(p1.lon, p1.lat) && !pointBack(p2.lon, p2.lat))
 		{
-			XuLine(surface, this, x1, y1, x2, y2, 8);
+			XuLine(surface, _land, x1, y1, x2, y2, 8);
 		}
 
 		p1 = p2;
@@ -1835,11 +1864,11 @@ void Globe::toggleRadarLines()
  */
 void Globe::resize()
 {
-	Surface *surfaces[4] = {this, _markers, _countries, _radars};
+	Surface *surfaces[5] = {this, _markers, _countries, _radars, _land};
 	int width = Options::baseXGeoscape - 64;
 	int height = Options::baseYGeoscape;
 
-	for (int i = 0; i < 4; ++i)
+	for (int i = 0; i < 5; ++i)
 	{
 		surfaces[i]->setWidth(width);
 		surfaces[i]->setHeight(height);
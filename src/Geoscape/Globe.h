@@ -50,6 +50,7 @@ private:
 	static const int CITY_MARKER = 8;
 	static const double ROTATE_LONGITUDE;
 	static const double ROTATE_LATITUDE;
+	static const double SHADOW_TOLERANCE;
 
 	RuleGlobe *_rules;
 	double _cenLon, _cenLat, _rotLon, _rotLat, _hoverLon, _hoverLat;
@@ -57,7 +58,10 @@ private:
 	size_t _zoom, _zoomOld, _zoomTexture;
 	SurfaceSet *_texture, *_markerSet;
 	Game *_game;
-	Surface *_markers, *_countries, *_radars;
+	Surface *_markers, *_countries, *_radars, *_land;
+	double _landLon, _landLat, _landRadius;
+	size_t _landZoom;
+	Cord _shadowSun;
 	bool _hover;
 	int _blink;
 	Timer *_blinkTimer, *_rotTimer;
@@ -173,7 +177,7 @@ public:
 	void drawOcean();
 	/// Draws the land of the globe.
 	void drawLand();
-	/// Draws the shadow.
+	/// Draws the land of the globe shaded by the sun.
 	void drawShadow();
 	/// Draws the radar ranges of the globe.
 	void drawRadars();
@@ -18,11 +18,12 @@
  */
 #include "MapDataSet.h"
 #include "MapData.h"
-#include <fstream>
+#include <cstring>
 #include <SDL_endian.h>
 #include "../Engine/Exception.h"
 #include "../Engine/SurfaceSet.h"
 #include "../Engine/FileMap.h"
+#include "../Engine/MappedFile.h"
 
 namespace OpenXcom
 {
@@ -159,14 +160,19 @@ void MapDataSet::loadData()
 
 	// Load Terrain Data from MCD file
 	std::string fname = "TERRAIN/" + _name + ".MCD";
-	std::ifstream mapFile(FileMap::getFilePath(fname).c_str(), std::ios::in | std::ios::binary);
-	if (!mapFile)
+	MappedFile mapFile(FileMap::getFilePath(fname));
+	if (!mapFile.isOpen())
 	{
 		throw Exception(fname + " not found");
 	}
+	if (mapFile.size() % sizeof(MCD) != 0)
+	{
+		throw Exception("Invalid MCD file");
+	}
 
-	while (mapFile.read((char*)&mcd, sizeof(MCD)))
+	for (size_t offset = 0; offset + sizeof(MCD) <= mapFile.size(); offset += sizeof(MCD))
 	{
+		memcpy(&mcd, mapFile.data() + offset, sizeof(MCD));
 		MapData *to = new MapData(this);
 		_objects.push_back(to);
 
@@ -210,14 +216,6 @@ void MapDataSet::loadData()
 		objNumber++;
 	}
 
-
-	if (!mapFile.eof())
-	{
-		throw Exception("Invalid MCD file");
-	}
-
-	mapFile.close();
-
 	// Load terrain sprites/surfaces/PCK files into a surfaceset
 	_surfaceSet = new SurfaceSet(32, 40);
 	_surfaceSet->loadPck(FileMap::getFilePath("TERRAIN/" + _name + ".PCK"),
@@ -249,26 +247,23 @@ void MapDataSet::unloadData()
 void MapDataSet::loadLOFTEMPS(const std::string &filename, std::vector<Uint16> *voxelData)
 {
 	// Load file
-	std::ifstream mapFile (filename.c_str(), std::ios::in | std::ios::binary);
-	if (!mapFile)
+	MappedFile mapFile(filename);
+	if (!mapFile.isOpen())
 	{
 		throw Exception(filename + " not found");
 	}
-
-	Uint16 value;
-
-	while (mapFile.read((char*)&value, sizeof(value)))
+	if (mapFile.size() % sizeof(Uint16) != 0)
 	{
-		value = SDL_SwapLE16(value);
-		voxelData->push_back(value);
+		throw Exception("Invalid LOFTEMPS");
 	}
 
-	if (!mapFile.eof())
+	const Uint8 *data = mapFile.data();
+	size_t count = mapFile.size() / sizeof(Uint16);
+	voxelData->reserve(voxelData->size() + count);
+	for (size_t i = 0; i < count; ++i)
 	{
-		throw Exception("Invalid LOFTEMPS");
+		voxelData->push_back(data[i * 2] | (data[i * 2 + 1] << 8));
 	}
-
-	mapFile.close();
 }
 
 /**
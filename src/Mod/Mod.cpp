@@ -20,6 +20,7 @@
 #include <algorithm>
 #include <sstream>
 #include <climits>
+#include <fstream>
 #include "../Engine/CrossPlatform.h"
 #include "../Engine/FileMap.h"
 #include "../Engine/Palette.h"
@@ -46,6 +47,7 @@
 #include "../fmath.h"
 #include "../Engine/RNG.h"
 #include "../Engine/Options.h"
+#include "../Engine/WorkerPool.h"
 #include "../Battlescape/Pathfinding.h"
 #include "RuleCountry.h"
 #include "RuleRegion.h"
@@ -66,6 +68,7 @@
 #include "RuleResearch.h"
 #include "RuleManufacture.h"
 #include "ExtraStrings.h"
+#include "RulesetCache.h"
 #include "RuleInterface.h"
 #include "RuleMissionScript.h"
 #include "../Geoscape/Globe.h"
@@ -660,17 +663,91 @@ int Mod::getSoundOffset(int sound, const std::string& set) const
 		return sound;
 }
 
+namespace
+{
+	/**
+	 * Parses ruleset files into YAML documents, one file per part,
+	 * so they can be read on several threads at once.
+	 */
+	class RulesetParseJob : public WorkerPool::Job
+	{
+	private:
+		const std::vector<std::string> &_files;
+		std::vector<YAML::Node> &_docs;
+		std::vector<std::string> &_errors;
+		std::vector<Uint64> &_times;
+	public:
+		/// Creates a job to parse a list of files.
+		RulesetParseJob(const std::vector<std::string> &files, std::vector<YAML::Node> &docs, std::vector<std::string> &errors, std::vector<Uint64> &times) : _files(files), _docs(docs), _errors(errors), _times(times)
+		{
+		}
+		/// Parses a single file, keeping any error for when it's applied.
+		void run(int index, int)
+		{
+			Uint64 start = CrossPlatform::getMicroseconds();
+			try
+			{
+				_docs[index] = YAML::LoadFile(_files[index]);
+			}
+			catch (std::exception &e)
+			{
+				_errors[index] = e.what();
+			}
+			_times[index] = CrossPlatform::getMicroseconds() - start;
+		}
+	};
+}
+
 /**
  * Loads a list of mods specified in the options.
+ * All the ruleset files are parsed up front on worker threads
+ * (or taken from the ruleset cache if none of them changed),
+ * then applied one mod at a time in order, so later mods still
+ * override earlier ones.
  * @param mods List of <modId, rulesetFiles> pairs.
  */
 void Mod::loadAll(const std::vector< std::pair< std::string, std::vector<std::string> > > &mods)
 {
+	std::vector<std::string> files;
+	for (size_t i = 0; mods.size() > i; ++i)
+	{
+		files.insert(files.end(), mods[i].second.begin(), mods[i].second.end());
+	}
+	std::vector<YAML::Node> docs(files.size());
+	std::vector<std::string> errors(files.size());
+	std::vector<Uint64> times(files.size());
+	Uint64 start = CrossPlatform::getMicroseconds();
+	std::string cacheFile = Options::getUserFolder() + "rulesets.cache";
+	bool cached = RulesetCache::load(cacheFile, files, docs);
+	if (cached)
+	{
+		Log(LOG_INFO) << "Loaded " << files.size() << " ruleset files from cache in " << (CrossPlatform::getMicroseconds() - start) / 1000 << " ms";
+	}
+	else
+	{
+		{
+			WorkerPool pool(std::max(0, Options::loaderThreads));
+			RulesetParseJob job(files, docs, errors, times);
+			pool.run(&job, 0, files.size());
+		}
+		Log(LOG_INFO) << "Parsed " << files.size() << " ruleset files in " << (CrossPlatform::getMicroseconds() - start) / 1000 << " ms";
+		for (size_t i = 0; files.size() > i; ++i)
+		{
+			Log(LOG_VERBOSE) << "- " << files[i] << ": parsed in " << times[i] / 1000.0 << " ms";
+		}
+	}
+
+	start = CrossPlatform::getMicroseconds();
+	size_t offset = 0;
 	for (size_t i = 0; mods.size() > i; ++i)
 	{
+		size_t count = mods[i].second.size();
+		std::vector<YAML::Node> modDocs(docs.begin() + offset, docs.begin() + offset + count);
+		std::vector<std::string> modErrors(errors.begin() + offset, errors.begin() + offset + count);
+		offset += count;
 		try
 		{
-			loadMod(mods[i].second, i);
+			loadMod(mods[i].second, modDocs, modErrors, i);
 		}
 		catch (Exception &e)
 		{
@@ -697,7 +774,13 @@ void Mod::loadAll(const std::vector< std::pair< std::string, std::vector<std::st
 				e.what());
 		}
 	}
+	Log(LOG_INFO) << "Applied " << files.size() << " ruleset files in " << (CrossPlatform::getMicroseconds() - start) / 1000 << " ms";
+	if (!cached)
+	{
+		RulesetCache::save(cacheFile, files, docs);
+	}
 	sortLists();
+	_globe->buildPolygonCells();
 	loadExtraResources();
 	modResources();
 }
@@ -706,23 +789,30 @@ void Mod::loadAll(const std::vector< std::pair< std::string, std::vector<std::st
  * Loads a list of rulesets from YAML files for the mod at the specified index. The first
  * mod loaded should be the master at index 0, then 1, and so on.
  * @param rulesetFiles List of rulesets to load.
+ * @param docs Parsed contents of each ruleset.
+ * @param errors Errors from parsing each ruleset, empty if there were none.
  * @param modIdx Mod index number.
  */
-void Mod::loadMod(const std::vector<std::string> &rulesetFiles, size_t modIdx)
+void Mod::loadMod(const std::vector<std::string> &rulesetFiles, const std::vector<YAML::Node> &docs, const std::vector<std::string> &errors, size_t modIdx)
 {
 	_modOffset = 1000 * modIdx;
 
-	for (std::vector<std::string>::const_iterator i = rulesetFiles.begin(); i != rulesetFiles.end(); ++i)
+	for (size_t i = 0; i < rulesetFiles.size(); ++i)
 	{
-		Log(LOG_VERBOSE) << "- " << *i;
+		if (!errors[i].empty())
+		{
+			throw Exception(rulesetFiles[i] + ": " + errors[i]);
+		}
+		Uint64 start = CrossPlatform::getMicroseconds();
 		try
 		{
-			loadFile(*i);
+			loadFile(docs[i]);
 		}
 		catch (YAML::Exception &e)
 		{
-			throw Exception((*i) + ": " + std::string(e.what()));
+			throw Exception(rulesetFiles[i] + ": " + std::string(e.what()));
 		}
+		Log(LOG_VERBOSE) << "- " << rulesetFiles[i] << ": applied in " << (CrossPlatform::getMicroseconds() - start) / 1000.0 << " ms";
 	}
 
 	// these need to be validated, otherwise we're gonna get into some serious trouble down the line.
@@ -789,13 +879,12 @@ void Mod::loadMod(const std::vector<std::string> &rulesetFiles, size_t modIdx)
 }
 
 /**
- * Loads a ruleset's contents from a YAML file.
+ * Loads a ruleset's contents from a parsed YAML file.
  * Rules that match pre-existing rules overwrite them.
- * @param filename YAML filename.
+ * @param doc YAML document.
  */
-void Mod::loadFile(const std::string &filename)
+void Mod::loadFile(const YAML::Node &doc)
 {
-	YAML::Node doc = YAML::LoadFile(filename);
 
 	for (YAML::const_iterator i = doc["countries"].begin(); i != doc["countries"].end(); ++i)
 	{
@@ -2628,6 +2717,162 @@ void Mod::loadVanillaResources()
 	loadBattlescapeResources(); // TODO load this at battlescape start, unload at battlescape end?
 }
 
+namespace
+{
+	/**
+	 * Finds the closest palette colors to arbitrary RGB colors.
+	 * The palette is kept sorted by red, so a search can start at the
+	 * desired red and stop as soon as the red difference alone is worse
+	 * than the best match, instead of comparing against all 256 colors.
+	 */
+	class ColorMatcher
+	{
+	private:
+		std::vector<std::pair<int, int> > _byRed;
+		SDL_Color *_colors;
+	public:
+		/// Sorts the palette colors for searching.
+		ColorMatcher(Palette *pal) : _colors(pal->getColors())
+		{
+			for (int i = 0; i < 256; ++i)
+			{
+				_byRed.push_back(std::make_pair((int)_colors[i].r, i));
+			}
+			std::sort(_byRed.begin(), _byRed.end());
+		}
+		/// Checks one palette color against the best match so far.
+		inline bool check(size_t pos, const SDL_Color &desired, int &closest, int &lowestDifference) const
+		{
+			int redDifference = Sqr(desired.r - _byRed[pos].first);
+			if (redDifference > lowestDifference)
+			{
+				return false;
+			}
+			int index = _byRed[pos].second;
+			int currentDifference = redDifference +
+				Sqr(desired.g - _colors[index].g) +
+				Sqr(desired.b - _colors[index].b);
+			// ties go to the lowest index, same as comparing the colors in order
+			if (currentDifference < lowestDifference || (currentDifference == lowestDifference && index < closest))
+			{
+				closest = index;
+				lowestDifference = currentDifference;
+			}
+			return true;
+		}
+		/// Gets the palette index closest to a color.
+		Uint8 closest(const SDL_Color &desired) const
+		{
+			int closest = 0;
+			int lowestDifference = INT_MAX;
+			size_t start = std::lower_bound(_byRed.begin(), _byRed.end(), std::make_pair((int)desired.r, 0)) - _byRed.begin();
+			for (size_t up = start; up < _byRed.size() && check(up, desired, closest, lowestDifference); ++up);
+			for (size_t down = start; down > 0 && check(down - 1, desired, closest, lowestDifference); --down);
+			return closest;
+		}
+	};
+
+	const Uint32 TransparencyCacheMagic = 0x4F58544C;
+	const Uint32 TransparencyCacheVersion = 1;
+
+	/**
+	 * Hashes everything a transparency lookup table is built from,
+	 * so it can be found again in the cache.
+	 * @param pal Palette the table is for.
+	 * @param tints Tints from the rulesets.
+	 * @return 64-bit FNV-1a hash.
+	 */
+	Uint64 hashTransparencyLUT(Palette *pal, const std::vector<SDL_Color> &tints)
+	{
+		Uint64 hash = 14695981039346656037ULL;
+		const Uint64 prime = 1099511628211ULL;
+		for (int i = 0; i < 256; ++i)
+		{
+			hash = (hash ^ pal->getColors(i)->r) * prime;
+			hash = (hash ^ pal->getColors(i)->g) * prime;
+			hash = (hash ^ pal->getColors(i)->b) * prime;
+		}
+		for (std::vector<SDL_Color>::const_iterator i = tints.begin(); i != tints.end(); ++i)
+		{
+			hash = (hash ^ i->r) * prime;
+			hash = (hash ^ i->g) * prime;
+			hash = (hash ^ i->b) * prime;
+			hash = (hash ^ i->unused) * prime;
+		}
+		return hash;
+	}
+
+	/**
+	 * Loads previously built transparency lookup tables.
+	 * A missing, outdated or damaged file just leaves the cache empty.
+	 * @param filename Cache file.
+	 * @param cache Map to fill with tables by hash.
+	 */
+	void loadTransparencyCache(const std::string &filename, std::map<Uint64, std::vector<Uint8> > &cache)
+	{
+		std::ifstream file(filename.c_str(), std::ios::in | std::ios::binary);
+		Uint32 magic = 0, version = 0, count = 0;
+		file.read((char*)&magic, sizeof(magic));
+		file.read((char*)&version, sizeof(version));
+		file.read((char*)&count, sizeof(count));
+		if (!file || magic != TransparencyCacheMagic || version != TransparencyCacheVersion)
+		{
+			return;
+		}
+		for (Uint32 i = 0; i < count; ++i)
+		{
+			Uint64 hash = 0;
+			Uint32 size = 0;
+			file.read((char*)&hash, sizeof(hash));
+			file.read((char*)&size, sizeof(size));
+			if (!file || size % 256 != 0 || size > 256 * 256 * 256)
+			{
+				cache.clear();
+				return;
+			}
+			std::vector<Uint8> &lut = cache[hash];
+			lut.resize(size);
+			if (size != 0)
+			{
+				file.read((char*)&lut[0], size);
+			}
+			if (!file)
+			{
+				cache.clear();
+				return;
+			}
+		}
+	}
+
+	/**
+	 * Saves the transparency lookup tables for the next startup.
+	 * @param filename Cache file.
+	 * @param cache Tables by hash.
+	 */
+	void saveTransparencyCache(const std::string &filename, const std::map<Uint64, std::vector<Uint8> > &cache)
+	{
+		std::ofstream file(filename.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+		Uint32 count = cache.size();
+		file.write((const char*)&TransparencyCacheMagic, sizeof(TransparencyCacheMagic));
+		file.write((const char*)&TransparencyCacheVersion, sizeof(TransparencyCacheVersion));
+		file.write((const char*)&count, sizeof(count));
+		for (std::map<Uint64, std::vector<Uint8> >::const_iterator i = cache.begin(); i != cache.end(); ++i)
+		{
+			Uint32 size = i->second.size();
+			file.write((const char*)&i->first, sizeof(i->first));
+			file.write((const char*)&size, sizeof(size));
+			if (size != 0)
+			{
+				file.write((const char*)&i->second[0], size);
+			}
+		}
+		if (!file)
+		{
+			Log(LOG_WARNING) << "Failed to save " << filename;
+		}
+	}
+}
+
 /**
  * Loads the resources required by the Battlescape.
  */
@@ -2708,6 +2953,11 @@ void Mod::loadBattlescapeResources()
 	{ 2, 9, 24, 255 },
 	{ 2, 0, 24, 255 } };
 
+	Uint64 lutStart = CrossPlatform::getMicroseconds();
+	std::string lutCacheFile = Options::getUserFolder() + "transparency.cache";
+	std::map<Uint64, std::vector<Uint8> > lutCached, lutUsed;
+	loadTransparencyCache(lutCacheFile, lutCached);
+	int lutBuilt = 0, lutReused = 0;
 	std::set<std::string> ufographContents = FileMap::getVFolderContents("UFOGRAPH");
 	for (size_t i = 0; i < sizeof(lbms) / sizeof(lbms[0]); ++i)
 	{
@@ -2727,9 +2977,21 @@ void Mod::loadBattlescapeResources()
 		SDL_Color *colors = tempSurface->getPalette();
 		colors[255] = backPal[i];
 		_palettes[pals[i]]->setColors(colors, 256);
-		createTransparencyLUT(_palettes[pals[i]]);
+		if (createTransparencyLUT(_palettes[pals[i]], lutCached, lutUsed))
+		{
+			lutBuilt++;
+		}
+		else
+		{
+			lutReused++;
+		}
 		delete tempSurface;
 	}
+	if (lutBuilt != 0 || lutUsed.size() != lutCached.size())
+	{
+		saveTransparencyCache(lutCacheFile, lutUsed);
+	}
+	Log(LOG_INFO) << "Transparency lookup tables: " << lutBuilt << " built, " << lutReused << " cached, " << (CrossPlatform::getMicroseconds() - lutStart) / 1000 << " ms";
 
 	std::string spks[] = { "TAC01.SCR",
 		"DETBORD.PCK",
@@ -3403,15 +3665,29 @@ Music *Mod::loadMusic(MusicFormat fmt, const std::string &file, int track, float
  * Preamble:
  * this is the most horrible function i've ever written, and it makes me sad.
  * this is, however, a necessary evil, in order to save massive amounts of time in the draw function.
- * when used with the default TFTD mod, this function loops 4,194,304 times
- * (4 palettes, 4 tints, 4 levels of opacity, 256 colors, 256 comparisons per)
- * each additional tint in the rulesets will result in over a million iterations more.
+ * when used with the default TFTD mod, this function looks up 16,384 colors
+ * (4 palettes, 4 tints, 4 levels of opacity, 256 colors)
+ * each additional tint in the rulesets will result in 4,096 lookups more.
+ * Tables built on a previous startup are taken from the cache instead.
  * @param pal the palette to base the lookup table on.
+ * @param cached Tables loaded from the cache file.
+ * @param used Tables to save in the cache file.
+ * @return True if the table had to be built.
  */
-void Mod::createTransparencyLUT(Palette *pal)
+bool Mod::createTransparencyLUT(Palette *pal, const std::map<Uint64, std::vector<Uint8> > &cached, std::map<Uint64, std::vector<Uint8> > &used)
 {
+	Uint64 hash = hashTransparencyLUT(pal, _transparencies);
+	std::map<Uint64, std::vector<Uint8> >::const_iterator hit = cached.find(hash);
+	if (hit != cached.end())
+	{
+		_transparencyLUTs.push_back(hit->second);
+		used[hash] = hit->second;
+		return false;
+	}
+
 	SDL_Color desiredColor;
 	std::vector<Uint8> lookUpTable;
+	ColorMatcher matcher(pal);
 	// start with the color sets
 	for (std::vector<SDL_Color>::const_iterator tint = _transparencies.begin(); tint != _transparencies.end(); ++tint)
 	{
@@ -3429,26 +3705,14 @@ void Mod::createTransparencyLUT(Palette *pal)
 				desiredColor.g = std::min(255, (int)(pal->getColors(currentColor)->g) + (tint->g * opacity));
 				desiredColor.b = std::min(255, (int)(pal->getColors(currentColor)->b) + (tint->b * opacity));
 
-				Uint8 closest = 0;
-				int lowestDifference = INT_MAX;
-				// now compare each color in the palette to find the closest match to our desired one
-				for (int comparator = 0; comparator < 256; ++comparator)
-				{
-					int currentDifference = Sqr(desiredColor.r - pal->getColors(comparator)->r) +
-						Sqr(desiredColor.g - pal->getColors(comparator)->g) +
-						Sqr(desiredColor.b - pal->getColors(comparator)->b);
-
-					if (currentDifference < lowestDifference)
-					{
-						closest = comparator;
-						lowestDifference = currentDifference;
-					}
-				}
-				lookUpTable.push_back(closest);
+				// now find the closest match in the palette to our desired one
+				lookUpTable.push_back(matcher.closest(desiredColor));
 			}
 		}
 	}
 	_transparencyLUTs.push_back(lookUpTable);
+	used[hash] = lookUpTable;
+	return true;
 }
 
 StatAdjustment *Mod::getStatAdjustment(int difficulty)
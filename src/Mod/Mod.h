@@ -151,7 +151,7 @@ private:
 	std::vector<std::string> _psiRequirements; // it's a cache for psiStrengthEval
 
 	/// Loads a ruleset from a YAML file.
-	void loadFile(const std::string &filename);
+	void loadFile(const YAML::Node &doc);
 	/// Loads a ruleset element.
 	template <typename T>
 	T *loadRule(const YAML::Node &node, std::map<std::string, T*> *map, std::vector<std::string> *index = 0, const std::string &key = "type") const;
@@ -168,10 +168,10 @@ private:
 	bool isImageFile(std::string extension) const;
 	/// Loads a specified music file.
 	Music *loadMusic(MusicFormat fmt, const std::string &file, int track, float volume, CatFile *adlibcat, CatFile *aintrocat, GMCatFile *gmcat) const;
-	/// Creates a transparency lookup table for a given palette.
-	void createTransparencyLUT(Palette *pal);
+	/// Creates a transparency lookup table for a given palette, or takes it from the cache.
+	bool createTransparencyLUT(Palette *pal, const std::map<Uint64, std::vector<Uint8> > &cached, std::map<Uint64, std::vector<Uint8> > &used);
 	/// Loads a specified mod content.
-	void loadMod(const std::vector<std::string> &rulesetFiles, size_t modIdx);
+	void loadMod(const std::vector<std::string> &rulesetFiles, const std::vector<YAML::Node> &docs, const std::vector<std::string> &errors, size_t modIdx);
 	/// Loads resources from vanilla.
 	void loadVanillaResources();
 	/// Loads resources from extra rulesets.
@@ -31,6 +31,28 @@
 namespace OpenXcom
 {
 
+namespace
+{
+	/// Size of the cells in the polygon lookup grid, in degrees.
+	const int CellSize = 2;
+	const int CellsLon = 360 / CellSize, CellsLat = 180 / CellSize;
+
+	/// Gets the unit vector pointing at a point on the globe.
+	void toVector(double lon, double lat, double v[3])
+	{
+		v[0] = cos(lat) * cos(lon);
+		v[1] = cos(lat) * sin(lon);
+		v[2] = sin(lat);
+	}
+
+	/// Gets the angle between two unit vectors.
+	double angleBetween(const double a[3], const double b[3])
+	{
+		double dot = a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+		return acos(std::max(-1.0, std::min(1.0, dot)));
+	}
+}
+
 /**
  * Creates a blank ruleset for globe contents.
  */
@@ -148,6 +170,103 @@ std::list<Polygon*> *RuleGlobe::getPolygons()
 	return &_polygons;
 }
 
+/**
+ * Builds a grid over the globe listing, for each cell, the polygons
+ * that could contain a point in it, in the same order as the full list.
+ * Globe::getPolygonFromLonLat() only finds a point in a polygon if it's
+ * within the spherical hull of its corners, so each polygon goes in
+ * the cells overlapping a circle around its corners. An extra cell
+ * at the end lists every polygon, for points off the grid.
+ */
+void RuleGlobe::buildPolygonCells()
+{
+	const double cellSize = CellSize * M_PI / 180;
+	// padded a little so rounding can only add polygons to a cell, never leave them out
+	const double pad = 1e-6;
+	std::vector<double> cellCenters(CellsLon * CellsLat * 3), cellRadius(CellsLat);
+	for (int y = 0; y < CellsLat; ++y)
+	{
+		double latMin = y * cellSize - M_PI_2;
+		double center[3], corners[2][3];
+		toVector(cellSize / 2, latMin + cellSize / 2, center);
+		toVector(0, latMin, corners[0]);
+		toVector(0, latMin + cellSize, corners[1]);
+		cellRadius[y] = std::max(angleBetween(center, corners[0]), angleBetween(center, corners[1]));
+		for (int x = 0; x < CellsLon; ++x)
+		{
+			toVector((x + 0.5) * cellSize, latMin + cellSize / 2, &cellCenters[(y * CellsLon + x) * 3]);
+		}
+	}
+
+	_polygonCells.assign(CellsLon * CellsLat + 1, std::vector<Polygon*>());
+	for (std::list<Polygon*>::iterator i = _polygons.begin(); i != _polygons.end(); ++i)
+	{
+		double center[3] = { 0, 0, 0 }, radius = 0;
+		for (int j = 0; j < (*i)->getPoints(); ++j)
+		{
+			double corner[3];
+			toVector((*i)->getLongitude(j), (*i)->getLatitude(j), corner);
+			for (int k = 0; k < 3; ++k)
+			{
+				center[k] += corner[k];
+			}
+		}
+		double length = sqrt(center[0] * center[0] + center[1] * center[1] + center[2] * center[2]);
+		if (length > pad)
+		{
+			for (int k = 0; k < 3; ++k)
+			{
+				center[k] /= length;
+			}
+			for (int j = 0; j < (*i)->getPoints(); ++j)
+			{
+				double corner[3];
+				toVector((*i)->getLongitude(j), (*i)->getLatitude(j), corner);
+				radius = std::max(radius, angleBetween(center, corner));
+			}
+		}
+		// the circle only bounds the hull if it fits in a hemisphere
+		bool everywhere = length <= pad || radius >= M_PI_2 - pad;
+		for (int y = 0; y < CellsLat; ++y)
+		{
+			double minDot = cos(std::min(radius + cellRadius[y] + pad, M_PI));
+			for (int x = 0; x < CellsLon; ++x)
+			{
+				const double *cellCenter = &cellCenters[(y * CellsLon + x) * 3];
+				if (everywhere || center[0] * cellCenter[0] + center[1] * cellCenter[1] + center[2] * cellCenter[2] >= minDot)
+				{
+					_polygonCells[y * CellsLon + x].push_back(*i);
+				}
+			}
+		}
+		_polygonCells.back().push_back(*i);
+	}
+}
+
+/**
+ * Returns the world polygons that might contain a point,
+ * from the grid built by buildPolygonCells().
+ * @param lon Longitude of the point.
+ * @param lat Latitude of the point.
+ * @return List of polygons, in the same order as the full list.
+ */
+const std::vector<Polygon*> &RuleGlobe::getPolygonsAt(double lon, double lat) const
+{
+	const double cellSize = CellSize * M_PI / 180;
+	lon = fmod(lon, 2 * M_PI);
+	if (lon < 0)
+	{
+		lon += 2 * M_PI;
+	}
+	if (!(lon >= 0 && lon <= 2 * M_PI && lat >= -M_PI_2 && lat <= M_PI_2))
+	{
+		return _polygonCells.back();
+	}
+	int x = std::max(0, std::min((int)(lon / cellSize), CellsLon - 1));
+	int y = std::max(0, std::min((int)((lat + M_PI_2) / cellSize), CellsLat - 1));
+	return _polygonCells[y * CellsLon + x];
+}
+
 /**
  * Returns the list of polylines in the globe.
  * @return Pointer to the list of polylines.
@@ -18,6 +18,7 @@
  * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
  */
 #include <list>
+#include <vector>
 #include <string>
 #include <yaml-cpp/yaml.h>
 
@@ -39,6 +40,7 @@ private:
 	std::list<Polygon*> _polygons;
 	std::list<Polyline*> _polylines;
 	std::map<int, Texture*> _textures;
+	std::vector< std::vector<Polygon*> > _polygonCells;
 public:
 	/// Creates a blank globe ruleset.
 	RuleGlobe();
@@ -48,6 +50,10 @@ public:
 	void load(const YAML::Node& node);
 	/// Gets the list of world polygons.
 	std::list<Polygon*> *getPolygons();
+	/// Builds the lookup grid of world polygons.
+	void buildPolygonCells();
+	/// Gets the world polygons that might contain a point.
+	const std::vector<Polygon*> &getPolygonsAt(double lon, double lat) const;
 	/// Gets the list of world polylines.
 	std::list<Polyline*> *getPolylines();
 	/// Loads a set of polygons from a DAT file.
@@ -0,0 +1,152 @@
+/*
+ * Copyright 2010-2016 OpenXcom Developers.
+ *
+ * This file is part of OpenXcom.
+ *
+ * OpenXcom is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenXcom is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "RulesetCache.h"
+#include <fstream>
+#include <sstream>
+#include <sys/stat.h>
+#include "../Engine/Logger.h"
+#include "../Engine/BinaryNode.h"
+
+namespace OpenXcom
+{
+
+namespace
+{
+	const char CacheMagic[4] = { 'O', 'X', 'R', 'C' };
+	const Uint32 CacheVersion = 2;
+}
+
+/**
+ * Gets the modified date and size of a ruleset file,
+ * which are checked before bothering to hash its data.
+ * @param path Full path to the file.
+ * @return Stamp string, empty if the file is missing.
+ */
+std::string RulesetCache::getStamp(const std::string &path)
+{
+	std::ostringstream stamp;
+	struct stat info;
+	if (stat(path.c_str(), &info) == 0)
+	{
+		stamp << info.st_mtime << " " << info.st_size;
+	}
+	return stamp.str();
+}
+
+/**
+ * Gets a hash of the data of a ruleset file.
+ * @param path Full path to the file.
+ * @return Hash string.
+ */
+std::string RulesetCache::getHash(const std::string &path)
+{
+	std::ifstream file(path.c_str(), std::ios::in | std::ios::binary);
+	Uint64 hash = 14695981039346656037ULL;
+	char buffer[4096];
+	while (file.read(buffer, sizeof(buffer)) || file.gcount() > 0)
+	{
+		for (std::streamsize j = 0; j < file.gcount(); ++j)
+		{
+			hash = (hash ^ (Uint8)buffer[j]) * 1099511628211ULL;
+		}
+	}
+	std::ostringstream str;
+	str << hash;
+	return str.str();
+}
+
+/**
+ * Loads the parsed ruleset files from the cache, if it was
+ * saved from exactly the same ruleset files. Files with the same
+ * modified date and size as when the cache was saved are taken
+ * as unchanged, the others are only used if their data hashes
+ * the same as before.
+ * @param filename Cache file.
+ * @param files Ruleset files, in the order they're loaded.
+ * @param docs Vector to fill with a document for each ruleset file.
+ * @return True if the cache could be used.
+ */
+bool RulesetCache::load(const std::string &filename, const std::vector<std::string> &files, std::vector<YAML::Node> &docs)
+{
+	std::ifstream file(filename.c_str(), std::ios::in | std::ios::binary);
+	if (!file)
+	{
+		return false;
+	}
+	std::string in((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+	size_t pos = sizeof(CacheMagic);
+	Uint32 version, count;
+	if (in.compare(0, sizeof(CacheMagic), CacheMagic, sizeof(CacheMagic)) != 0 ||
+		!BinaryNode::readInt(in, pos, version) || version != CacheVersion ||
+		!BinaryNode::readInt(in, pos, count) || count != files.size())
+	{
+		return false;
+	}
+	for (Uint32 i = 0; i < count; ++i)
+	{
+		std::string path, stamp, hash;
+		if (!BinaryNode::readString(in, pos, path) || !BinaryNode::readString(in, pos, stamp) || !BinaryNode::readString(in, pos, hash) ||
+			path != files[i] || (stamp != getStamp(path) && hash != getHash(path)))
+		{
+			return false;
+		}
+	}
+	std::vector<YAML::Node> cached(count);
+	for (Uint32 i = 0; i < count; ++i)
+	{
+		if (!BinaryNode::read(in, pos, cached[i]))
+		{
+			Log(LOG_WARNING) << filename << " is damaged, parsing rulesets instead";
+			return false;
+		}
+	}
+	docs.swap(cached);
+	return true;
+}
+
+/**
+ * Saves the parsed ruleset files to the cache.
+ * @param filename Cache file.
+ * @param files Ruleset files, in the order they're loaded.
+ * @param docs Document for each ruleset file.
+ */
+void RulesetCache::save(const std::string &filename, const std::vector<std::string> &files, const std::vector<YAML::Node> &docs)
+{
+	std::string out(CacheMagic, sizeof(CacheMagic));
+	BinaryNode::writeInt(out, CacheVersion);
+	BinaryNode::writeInt(out, files.size());
+	for (std::vector<std::string>::const_iterator i = files.begin(); i != files.end(); ++i)
+	{
+		BinaryNode::writeString(out, *i);
+		BinaryNode::writeString(out, getStamp(*i));
+		BinaryNode::writeString(out, getHash(*i));
+	}
+	for (std::vector<YAML::Node>::const_iterator i = docs.begin(); i != docs.end(); ++i)
+	{
+		BinaryNode::write(out, *i);
+	}
+	std::ofstream file(filename.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+	file.write(out.data(), out.size());
+	if (!file)
+	{
+		Log(LOG_WARNING) << "Failed to save " << filename;
+	}
+}
+
+}
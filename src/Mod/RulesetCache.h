@@ -0,0 +1,50 @@
+#pragma once
+/*
+ * Copyright 2010-2016 OpenXcom Developers.
+ *
+ * This file is part of OpenXcom.
+ *
+ * OpenXcom is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenXcom is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <vector>
+#include <string>
+#include <yaml-cpp/yaml.h>
+#include <SDL_types.h>
+
+namespace OpenXcom
+{
+
+/**
+ * Keeps parsed ruleset files in a compact binary file, so the next
+ * startup with the same rulesets can rebuild the YAML documents
+ * straight from it instead of parsing the YAML text again.
+ * The cache is only used if every ruleset file is unchanged.
+ * This saves the YAML parsing only: the rules are still
+ * built from the documents by Mod::loadFile as usual.
+ */
+class RulesetCache
+{
+private:
+	/// Gets the modified date and size of a ruleset file.
+	static std::string getStamp(const std::string &path);
+	/// Gets a hash of the data of a ruleset file.
+	static std::string getHash(const std::string &path);
+public:
+	/// Loads the parsed ruleset files from the cache.
+	static bool load(const std::string &filename, const std::vector<std::string> &files, std::vector<YAML::Node> &docs);
+	/// Saves the parsed ruleset files to the cache.
+	static void save(const std::string &filename, const std::vector<std::string> &files, const std::vector<YAML::Node> &docs);
+};
+
+}
@@ -616,21 +616,13 @@ void AlienMission::addScore(double lon, double lat, SavedGame &game) const
 {
 	if (_rule.getObjective() == OBJECTIVE_INFILTRATION)
 		return; // pact score is a special case
-	for (std::vector<Region *>::iterator region = game.getRegions()->begin(); region != game.getRegions()->end(); ++region)
+	if (Region *region = game.locateRegion(lon, lat))
 	{
-		if ((*region)->getRules()->insideRegion(lon, lat))
-		{
-			(*region)->addActivityAlien(_rule.getPoints());
-			break;
-		}
+		region->addActivityAlien(_rule.getPoints());
 	}
-	for (std::vector<Country *>::iterator country = game.getCountries()->begin(); country != game.getCountries()->end(); ++country)
+	if (Country *country = game.locateCountry(lon, lat))
 	{
-		if ((*country)->getRules()->insideCountry(lon, lat))
-		{
-			(*country)->addActivityAlien(_rule.getPoints());
-			break;
-		}
+		country->addActivityAlien(_rule.getPoints());
 	}
 }
 
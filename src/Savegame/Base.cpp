@@ -52,7 +52,7 @@ namespace OpenXcom
  * Initializes an empty base.
  * @param mod Pointer to mod.
  */
-Base::Base(const Mod *mod) : Target(), _mod(mod), _scientists(0), _engineers(0), _inBattlescape(false), _retaliationTarget(false)
+Base::Base(const Mod *mod) : Target(), _mod(mod), _scientists(0), _engineers(0), _inBattlescape(false), _retaliationTarget(false), _facilityTotalsDirty(true)
 {
 	_items = new ItemContainer();
 }
@@ -116,7 +116,7 @@ void Base::load(const YAML::Node &node, SavedGame *save, bool newGame, bool newB
 			{
 				BaseFacility *f = new BaseFacility(_mod->getBaseFacility(type), this);
 				f->load(*i);
-				_facilities.push_back(f);
+				addFacility(f);
 			}
 			else
 			{
@@ -309,6 +309,9 @@ int Base::getMarker() const
 
 /**
  * Returns the list of facilities in the base.
+ * Facilities must be added and removed with the
+ * methods below so the facility totals are kept
+ * up to date.
  * @return Pointer to the facility list.
  */
 std::vector<BaseFacility*> *Base::getFacilities()
@@ -316,6 +319,135 @@ std::vector<BaseFacility*> *Base::getFacilities()
 	return &_facilities;
 }
 
+/**
+ * Adds a facility to the base.
+ * @param facility Pointer to the facility.
+ */
+void Base::addFacility(BaseFacility *facility)
+{
+	_facilities.push_back(facility);
+	invalidateFacilityTotals();
+}
+
+/**
+ * Removes a facility from the base. The facility
+ * itself is left for the caller to delete.
+ * @param facility Iterator to the facility.
+ */
+void Base::removeFacility(std::vector<BaseFacility*>::iterator facility)
+{
+	_facilities.erase(facility);
+	invalidateFacilityTotals();
+}
+
+/**
+ * Deletes all the facilities of the base.
+ */
+void Base::clearFacilities()
+{
+	for (std::vector<BaseFacility*>::iterator i = _facilities.begin(); i != _facilities.end(); ++i)
+	{
+		delete *i;
+	}
+	_facilities.clear();
+	invalidateFacilityTotals();
+}
+
+/**
+ * Marks the facility totals as out of date, so they're
+ * recalculated the next time they're needed. Called when
+ * a facility is added, removed, finished or unfinished.
+ */
+void Base::invalidateFacilityTotals()
+{
+	_facilityTotalsDirty = true;
+}
+
+/**
+ * Sums up the rules of all the completed facilities
+ * in the base in a single pass.
+ * @param totals Facility totals to fill in.
+ */
+void Base::calculateFacilityTotals(FacilityTotals &totals) const
+{
+	FacilityTotals t = {};
+	int minRadarRange = _mod->getMinRadarRange();
+	for (std::vector<BaseFacility*>::const_iterator i = _facilities.begin(); i != _facilities.end(); ++i)
+	{
+		if ((*i)->getBuildTime() != 0)
+		{
+			continue;
+		}
+		const RuleBaseFacility *rules = (*i)->getRules();
+		t.quarters += rules->getPersonnel();
+		t.stores += rules->getStorage();
+		t.laboratories += rules->getLaboratories();
+		t.workshops += rules->getWorkshops();
+		t.hangars += rules->getCrafts();
+		t.psiLabs += rules->getPsiLaboratories();
+		t.containment += rules->getAliens();
+		t.defense += rules->getDefenseValue();
+		if (minRadarRange != 0 && rules->getRadarRange() == minRadarRange)
+		{
+			t.shortRangeDetection++;
+		}
+		if (rules->getRadarRange() > minRadarRange)
+		{
+			t.longRangeDetection++;
+		}
+		t.maxRadarRange = std::max(t.maxRadarRange, rules->getRadarRange());
+		if (rules->isHyperwave())
+		{
+			t.hyperwaves++;
+		}
+		t.maintenance += rules->getMonthlyCost();
+		if (rules->isGravShield())
+		{
+			t.gravShields++;
+		}
+		if (rules->isMindShield())
+		{
+			t.mindShields++;
+		}
+		t.area += rules->getSize() * rules->getSize();
+	}
+	totals = t;
+}
+
+/**
+ * Returns the sums of the rules of all the completed
+ * facilities, only recalculating them after the
+ * facilities have changed. In debug mode the cached
+ * totals are checked against a fresh calculation.
+ * @return Facility totals.
+ */
+const Base::FacilityTotals &Base::getFacilityTotals() const
+{
+	if (_facilityTotalsDirty)
+	{
+		calculateFacilityTotals(_facilityTotals);
+		_facilityTotalsDirty = false;
+	}
+	else if (Options::debug)
+	{
+		FacilityTotals fresh;
+		calculateFacilityTotals(fresh);
+		if (fresh.quarters != _facilityTotals.quarters || fresh.stores != _facilityTotals.stores ||
+			fresh.laboratories != _facilityTotals.laboratories || fresh.workshops != _facilityTotals.workshops ||
+			fresh.hangars != _facilityTotals.hangars || fresh.psiLabs != _facilityTotals.psiLabs ||
+			fresh.containment != _facilityTotals.containment || fresh.defense != _facilityTotals.defense ||
+			fresh.shortRangeDetection != _facilityTotals.shortRangeDetection || fresh.longRangeDetection != _facilityTotals.longRangeDetection ||
+			fresh.maxRadarRange != _facilityTotals.maxRadarRange || fresh.hyperwaves != _facilityTotals.hyperwaves ||
+			fresh.maintenance != _facilityTotals.maintenance || fresh.gravShields != _facilityTotals.gravShields ||
+			fresh.mindShields != _facilityTotals.mindShields || fresh.area != _facilityTotals.area)
+		{
+			Log(LOG_WARNING) << "Facility totals of base " << Language::wstrToUtf8(_name) << " were out of date";
+			_facilityTotals = fresh;
+		}
+	}
+	return _facilityTotals;
+}
+
 /**
  * Returns the list of soldiers in the base.
  * @return Pointer to the soldier list.
@@ -454,6 +586,17 @@ int Base::insideRadarRange(Target *target) const
 	return insideRange? 1 : 0;
 }
 
+/**
+ * Returns the range of the longest reaching radar
+ * among the base's finished facilities. Targets
+ * further away can't be detected by the base.
+ * @return Range in nautical miles.
+ */
+int Base::getMaxRadarRange() const
+{
+	return getFacilityTotals().maxRadarRange;
+}
+
 /**
  * Returns the amount of soldiers contained
  * in the base without any assignments.
@@ -580,15 +723,7 @@ int Base::getUsedQuarters() const
  */
 int Base::getAvailableQuarters() const
 {
-	int total = 0;
-	for (std::vector<BaseFacility*>::const_iterator i = _facilities.begin(); i != _facilities.end(); ++i)
-	{
-		if ((*i)->getBuildTime() == 0)
-		{
-			total += (*i)->getRules()->getPersonnel();
-		}
-	}
-	return total;
+	return getFacilityTotals().quarters;
 }
 
 /**
@@ -646,15 +781,7 @@ bool Base::storesOverfull(double offset)
  */
 int Base::getAvailableStores() const
 {
-	int total = 0;
-	for (std::vector<BaseFacility*>::const_iterator i = _facilities.begin(); i != _facilities.end(); ++i)
-	{
-		if ((*i)->getBuildTime() == 0)
-		{
-			total += (*i)->getRules()->getStorage();
-		}
-	}
-	return total;
+	return getFacilityTotals().stores;
 }
 
 /**
@@ -716,15 +843,7 @@ int Base::getUsedLaboratories() const
  */
 int Base::getAvailableLaboratories() const
 {
-	int total = 0;
-	for (std::vector<BaseFacility*>::const_iterator i = _facilities.begin(); i != _facilities.end(); ++i)
-	{
-		if ((*i)->getBuildTime() == 0)
-		{
-			total += (*i)->getRules()->getLaboratories();
-		}
-	}
-	return total;
+	return getFacilityTotals().laboratories;
 }
 
 /**
@@ -749,15 +868,7 @@ int Base::getUsedWorkshops() const
  */
 int Base::getAvailableWorkshops() const
 {
-	int total = 0;
-	for (std::vector<BaseFacility*>::const_iterator i = _facilities.begin(); i != _facilities.end(); ++i)
-	{
-		if ((*i)->getBuildTime() == 0)
-		{
-			total += (*i)->getRules()->getWorkshops();
-		}
-	}
-	return total;
+	return getFacilityTotals().workshops;
 }
 
 /**
@@ -793,15 +904,7 @@ int Base::getUsedHangars() const
  */
 int Base::getAvailableHangars() const
 {
-	int total = 0;
-	for (std::vector<BaseFacility*>::const_iterator i = _facilities.begin(); i != _facilities.end(); ++i)
-	{
-		if ((*i)->getBuildTime() == 0)
-		{
-			total += (*i)->getRules()->getCrafts();
-		}
-	}
-	return total;
+	return getFacilityTotals().hangars;
 }
 
 /**
@@ -878,15 +981,7 @@ int Base::getAllocatedEngineers() const
  */
 int Base::getDefenseValue() const
 {
-	int total = 0;
-	for (std::vector<BaseFacility*>::const_iterator i = _facilities.begin(); i != _facilities.end(); ++i)
-	{
-		if ((*i)->getBuildTime() == 0)
-		{
-			total += (*i)->getRules()->getDefenseValue();
-		}
-	}
-	return total;
+	return getFacilityTotals().defense;
 }
 
 /**
@@ -896,18 +991,7 @@ int Base::getDefenseValue() const
  */
 int Base::getShortRangeDetection() const
 {
-	int total = 0;
-	int minRadarRange = _mod->getMinRadarRange();
-
-	if (minRadarRange == 0) return 0;
-	for (std::vector<BaseFacility*>::const_iterator i = _facilities.begin(); i != _facilities.end(); ++i)
-	{
-		if ((*i)->getRules()->getRadarRange() == minRadarRange && (*i)->getBuildTime() == 0)
-		{
-			total++;
-		}
-	}
-	return total;
+	return getFacilityTotals().shortRangeDetection;
 }
 
 /**
@@ -917,17 +1001,7 @@ int Base::getShortRangeDetection() const
  */
 int Base::getLongRangeDetection() const
 {
-	int total = 0;
-	int minRadarRange = _mod->getMinRadarRange();
-
-	for (std::vector<BaseFacility*>::const_iterator i = _facilities.begin(); i != _facilities.end(); ++i)
-	{
-		if ((*i)->getRules()->getRadarRange() > minRadarRange && (*i)->getBuildTime() == 0)
-		{
-			total++;
-		}
-	}
-	return total;
+	return getFacilityTotals().longRangeDetection;
 }
 
 /**
@@ -1035,15 +1109,7 @@ int Base::getPersonnelMaintenance() const
  */
 int Base::getFacilityMaintenance() const
 {
-	int total = 0;
-	for (std::vector<BaseFacility*>::const_iterator i = _facilities.begin(); i != _facilities.end(); ++i)
-	{
-		if ((*i)->getBuildTime() == 0)
-		{
-			total += (*i)->getRules()->getMonthlyCost();
-		}
-	}
-	return total;
+	return getFacilityTotals().maintenance;
 }
 
 /**
@@ -1129,14 +1195,7 @@ const std::vector<Production *> & Base::getProductions() const
  */
 bool Base::getHyperDetection() const
 {
-	for (std::vector<BaseFacility*>::const_iterator i = _facilities.begin(); i != _facilities.end(); ++i)
-	{
-		if ((*i)->getRules()->isHyperwave() && (*i)->getBuildTime() == 0)
-		{
-			return true;
-		}
-	}
-	return false;
+	return getFacilityTotals().hyperwaves != 0;
 }
 
 /**
@@ -1146,15 +1205,7 @@ bool Base::getHyperDetection() const
  */
 int Base::getAvailablePsiLabs() const
 {
-	int total = 0;
-	for (std::vector<BaseFacility*>::const_iterator i = _facilities.begin(); i != _facilities.end(); ++i)
-	{
-		if ((*i)->getBuildTime() == 0)
-		{
-			total += (*i)->getRules()->getPsiLaboratories();
-		}
-	}
-	return total;
+	return getFacilityTotals().psiLabs;
 }
 
 /**
@@ -1218,15 +1269,7 @@ int Base::getUsedContainment() const
  */
 int Base::getAvailableContainment() const
 {
-	int total = 0;
-	for (std::vector<BaseFacility*>::const_iterator i = _facilities.begin(); i != _facilities.end(); ++i)
-	{
-		if ((*i)->getBuildTime() == 0)
-		{
-			total += (*i)->getRules()->getAliens();
-		}
-	}
-	return total;
+	return getFacilityTotals().containment;
 }
 
 /**
@@ -1265,30 +1308,6 @@ bool Base::getRetaliationTarget() const
 	return _retaliationTarget;
 }
 
-/**
- * Functor to check for mind shield capability.
- */
-struct isMindShield: public std::unary_function<BaseFacility*, bool>
-{
-	/// Check isMindShield() for @a facility.
-	bool operator()(const BaseFacility *facility) const;
-};
-
-/**
- * Only fully operational facilities are checked.
- * @param facility Pointer to the facility to check.
- * @return If @a facility can act as a mind shield.
- */
-bool isMindShield::operator()(const BaseFacility *facility) const
-{
-	if (facility->getBuildTime() != 0)
-	{
-		// Still building this
-		return false;
-	}
-	return (facility->getRules()->isMindShield());
-}
-
 /**
  * Functor to check for completed facilities.
  */
@@ -1316,29 +1335,15 @@ bool isCompleted::operator()(const BaseFacility *facility) const
  */
 size_t Base::getDetectionChance() const
 {
-	size_t mindShields = std::count_if (_facilities.begin(), _facilities.end(), isMindShield());
-	size_t completedFacilities = 0;
-	for (std::vector<BaseFacility*>::const_iterator i = _facilities.begin(); i != _facilities.end(); ++i)
-	{
-		if ((*i)->getBuildTime() == 0)
-		{
-			completedFacilities += (*i)->getRules()->getSize() * (*i)->getRules()->getSize();
-		}
-	}
+	const FacilityTotals &totals = getFacilityTotals();
+	size_t mindShields = totals.mindShields;
+	size_t completedFacilities = totals.area;
 	return ((completedFacilities / 6 + 15) / (mindShields + 1));
 }
 
 int Base::getGravShields() const
 {
-	int total = 0;
-	for (std::vector<BaseFacility*>::const_iterator i = _facilities.begin(); i != _facilities.end(); ++i)
-	{
-		if ((*i)->getBuildTime() == 0 && (*i)->getRules()->isGravShield())
-		{
-			++total;
-		}
-	}
-	return total;
+	return getFacilityTotals().gravShields;
 }
 
 void Base::setupDefenses()
@@ -1716,7 +1721,7 @@ void Base::destroyFacility(std::vector<BaseFacility*>::iterator facility)
 		}
 	}
 	delete *facility;
-	_facilities.erase(facility);
+	removeFacility(facility);
 }
 
 /**
@@ -59,7 +59,20 @@ private:
 	bool _retaliationTarget;
 	std::vector<Vehicle*> _vehicles;
 	std::vector<BaseFacility*> _defenses;
+	/// Sums of the rules of all the completed facilities.
+	struct FacilityTotals
+	{
+		int quarters, stores, laboratories, workshops, hangars, psiLabs, containment;
+		int defense, shortRangeDetection, longRangeDetection, maxRadarRange, hyperwaves;
+		int maintenance, gravShields, mindShields, area;
+	};
+	mutable FacilityTotals _facilityTotals;
+	mutable bool _facilityTotalsDirty;
 
+	/// Sums up the rules of the completed facilities.
+	void calculateFacilityTotals(FacilityTotals &totals) const;
+	/// Gets the sums of the rules of the completed facilities.
+	const FacilityTotals &getFacilityTotals() const;
 	/// Determines space taken up by ammo clips about to rearm craft.
 	double getIgnoredStores();
 	/// Gets the base's default name (unused).
@@ -81,6 +94,14 @@ public:
 	int getMarker() const;
 	/// Gets the base's facilities.
 	std::vector<BaseFacility*> *getFacilities();
+	/// Adds a facility to the base.
+	void addFacility(BaseFacility *facility);
+	/// Removes a facility from the base without deleting it.
+	void removeFacility(std::vector<BaseFacility*>::iterator facility);
+	/// Deletes all the facilities of the base.
+	void clearFacilities();
+	/// Marks the facility totals as out of date.
+	void invalidateFacilityTotals();
 	/// Gets the base's soldiers.
 	std::vector<Soldier*> *getSoldiers();
 	/// Gets the base's crafts.
@@ -101,6 +122,8 @@ public:
 	int detect(Target *target) const;
 	/// Checks if a target is inside the base's radar range.
 	int insideRadarRange(Target *target) const;
+	/// Gets the range of the base's longest reaching radar.
+	int getMaxRadarRange() const;
 	/// Gets the base's available soldiers.
 	int getAvailableSoldiers(bool checkCombatReadiness = false) const;
 	/// Gets the base's total soldiers.
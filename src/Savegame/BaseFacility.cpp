@@ -131,6 +131,10 @@ int BaseFacility::getBuildTime() const
  */
 void BaseFacility::setBuildTime(int time)
 {
+	if ((time == 0) != (_buildTime == 0) && _base != 0)
+	{
+		_base->invalidateFacilityTotals();
+	}
 	_buildTime = time;
 }
 
@@ -140,6 +144,10 @@ void BaseFacility::setBuildTime(int time)
 void BaseFacility::build()
 {
 	_buildTime--;
+	if (_buildTime == 0 && _base != 0)
+	{
+		_base->invalidateFacilityTotals();
+	}
 }
 
 /**
@@ -691,6 +691,16 @@ void Craft::think()
 	}
 }
 
+/**
+ * Returns whether the craft is still taking off
+ * and hasn't started moving yet.
+ * @return True if it's taking off.
+ */
+bool Craft::isTakingOff() const
+{
+	return _takeoff != 0;
+}
+
 /**
  * Checks the condition of all the craft's systems
  * to define its new status (eg. when arriving at base).
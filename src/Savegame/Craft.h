@@ -138,6 +138,8 @@ public:
 	bool insideRadarRange(Target *target) const;
 	/// Handles craft logic.
 	void think();
+	/// Gets if the craft is still taking off.
+	bool isTakingOff() const;
 	/// Does a craft full checkup.
 	void checkup();
 	/// Consumes the craft's fuel.
@@ -136,6 +136,17 @@ TimeTrigger GameTime::advance()
 	return trigger;
 }
 
+/**
+ * Gets how many times the time can be advanced until one of them
+ * triggers more than the 5 second events. Every longer trigger
+ * falls on a 10 minute mark.
+ * @return Number of advances, counting the one with the trigger.
+ */
+int GameTime::getAdvancesToTrigger() const
+{
+	return (60 - _second) / 5 + (9 - _minute % 10) * 12;
+}
+
 /**
  * Returns the current ingame second.
  * @return Second (0-59).
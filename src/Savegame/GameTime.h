@@ -50,6 +50,8 @@ public:
 	YAML::Node save() const;
 	/// Advances the time by 5 seconds.
 	TimeTrigger advance();
+	/// Gets how many advances until the next 10 minute trigger.
+	int getAdvancesToTrigger() const;
 	/// Gets the ingame second.
 	int getSecond() const;
 	/// Gets the ingame minute.
@@ -19,6 +19,8 @@
 #include "ItemContainer.h"
 #include "../Mod/Mod.h"
 #include "../Mod/RuleItem.h"
+#include "../Engine/Options.h"
+#include "../Engine/Logger.h"
 
 namespace OpenXcom
 {
@@ -26,7 +28,7 @@ namespace OpenXcom
 /**
  * Initializes an item container with no contents.
  */
-ItemContainer::ItemContainer()
+ItemContainer::ItemContainer() : _totalQuantity(0), _totalSize(0.0), _totalSizeMod(0), _totalQuantityDirty(false)
 {
 }
 
@@ -44,6 +46,7 @@ ItemContainer::~ItemContainer()
 void ItemContainer::load(const YAML::Node &node)
 {
 	_qty = node.as< std::map<std::string, int> >(_qty);
+	invalidateTotals();
 }
 
 /**
@@ -73,6 +76,7 @@ void ItemContainer::addItem(const std::string &id, int qty)
 		_qty[id] = 0;
 	}
 	_qty[id] += qty;
+	invalidateTotals();
 }
 
 /**
@@ -94,6 +98,7 @@ void ItemContainer::removeItem(const std::string &id, int qty)
 	{
 		_qty.erase(id);
 	}
+	invalidateTotals();
 }
 
 /**
@@ -121,40 +126,75 @@ int ItemContainer::getItem(const std::string &id) const
 
 /**
  * Returns the total quantity of the items in the container.
+ * The total is only added up again after the contents change.
  * @return Total item quantity.
  */
 int ItemContainer::getTotalQuantity() const
 {
+	if (!_totalQuantityDirty && !Options::debug)
+	{
+		return _totalQuantity;
+	}
 	int total = 0;
 	for (std::map<std::string, int>::const_iterator i = _qty.begin(); i != _qty.end(); ++i)
 	{
 		total += i->second;
 	}
+	if (!_totalQuantityDirty && total != _totalQuantity)
+	{
+		Log(LOG_WARNING) << "Cached item quantity " << _totalQuantity << " was out of date, should be " << total;
+	}
+	_totalQuantity = total;
+	_totalQuantityDirty = false;
 	return total;
 }
 
 /**
  * Returns the total size of the items in the container.
+ * The total is only added up again after the contents change.
  * @param mod Pointer to mod.
  * @return Total item size.
  */
 double ItemContainer::getTotalSize(const Mod *mod) const
 {
+	if (_totalSizeMod == mod && !Options::debug)
+	{
+		return _totalSize;
+	}
 	double total = 0;
 	for (std::map<std::string, int>::const_iterator i = _qty.begin(); i != _qty.end(); ++i)
 	{
 		total += mod->getItem(i->first, true)->getSize() * i->second;
 	}
+	if (_totalSizeMod == mod && total != _totalSize)
+	{
+		Log(LOG_WARNING) << "Cached item size " << _totalSize << " was out of date, should be " << total;
+	}
+	_totalSize = total;
+	_totalSizeMod = mod;
 	return total;
 }
 
 /**
  * Returns all the items currently contained within.
+ * Since the contents can be changed through the pointer,
+ * the totals are added up again the next time they're needed.
  * @return List of contents.
  */
 std::map<std::string, int> *ItemContainer::getContents()
 {
+	invalidateTotals();
 	return &_qty;
 }
 
+/**
+ * Marks the cached quantity and size totals as
+ * out of date after the contents have changed.
+ */
+void ItemContainer::invalidateTotals()
+{
+	_totalQuantityDirty = true;
+	_totalSizeMod = 0;
+}
+
 }
@@ -35,6 +35,13 @@ class ItemContainer
 {
 private:
 	std::map<std::string, int> _qty;
+	mutable int _totalQuantity;
+	mutable double _totalSize;
+	mutable const Mod *_totalSizeMod;
+	mutable bool _totalQuantityDirty;
+
+	/// Marks the cached totals as out of date.
+	void invalidateTotals();
 public:
 	/// Creates an empty item container.
 	ItemContainer();
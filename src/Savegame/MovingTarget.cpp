@@ -17,6 +17,7 @@
  * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
  */
 #include "MovingTarget.h"
+#include <climits>
 #include "../fmath.h"
 #include "SerializationHelper.h"
 #include "../Engine/Options.h"
@@ -193,6 +194,41 @@ bool MovingTarget::reachedDestination() const
 	return ( AreSame(_dest->getLongitude(), _lon) && AreSame(_dest->getLatitude(), _lat) );
 }
 
+/**
+ * Gets how many movement cycles are sure to pass before the moving
+ * target reaches its destination, taking into account that the
+ * destination might be moving towards it too.
+ * @return Number of moves, or INT_MAX if it's not going anywhere.
+ */
+int MovingTarget::getMovesToDestination() const
+{
+	if (_dest == 0)
+	{
+		return INT_MAX;
+	}
+	if (reachedDestination())
+	{
+		return 0;
+	}
+	double closing = _speedRadian;
+	MovingTarget *u = dynamic_cast<MovingTarget*>(_dest);
+	if (u != 0)
+	{
+		closing += u->getSpeedRadian();
+	}
+	if (AreSame(closing, 0.0))
+	{
+		return INT_MAX;
+	}
+	// moves only follow the great circle approximately, so stay well clear of it
+	double moves = (getDistance(_dest) / closing - 2) * 0.5;
+	if (moves < 1)
+	{
+		return 0;
+	}
+	return moves < INT_MAX ? (int)moves : INT_MAX;
+}
+
 /**
  * Executes a movement cycle for the moving target.
  */
@@ -59,6 +59,8 @@ public:
 	void setSpeed(int speed);
 	/// Has the moving target reached its destination?
 	bool reachedDestination() const;
+	/// Gets how many moves are sure to pass before reaching the destination.
+	int getMovesToDestination() const;
 	/// Move towards the destination.
 	void move();
 	/// Calculate meeting point with the target.
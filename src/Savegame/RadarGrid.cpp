@@ -0,0 +1,122 @@
+/*
+ * Copyright 2010-2016 OpenXcom Developers.
+ *
+ * This file is part of OpenXcom.
+ *
+ * OpenXcom is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenXcom is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "RadarGrid.h"
+#include <algorithm>
+#include "../fmath.h"
+#include "Base.h"
+#include "Craft.h"
+#include "../Mod/RuleCraft.h"
+
+namespace OpenXcom
+{
+
+namespace
+{
+	/// Size of the cells in the grid, in degrees.
+	const int CellSize = 5;
+	const int CellsLon = 360 / CellSize, CellsLat = 180 / CellSize;
+}
+
+/**
+ * Sorts the radars of every base and its craft into the cells of
+ * the globe they can reach. Every radar also goes in an extra cell
+ * at the end, for targets off the grid.
+ * @param bases List of bases.
+ */
+RadarGrid::RadarGrid(const std::vector<Base*> &bases) : _cells(CellsLon * CellsLat + 1)
+{
+	for (std::vector<Base*>::const_iterator i = bases.begin(); i != bases.end(); ++i)
+	{
+		Radar radar = { *i, 0 };
+		addRadar(radar, *i, (*i)->getMaxRadarRange());
+		for (std::vector<Craft*>::iterator j = (*i)->getCrafts()->begin(); j != (*i)->getCrafts()->end(); ++j)
+		{
+			if ((*j)->getStatus() == "STR_OUT")
+			{
+				radar.craft = *j;
+				addRadar(radar, *j, (*j)->getRules()->getRadarRange());
+			}
+		}
+	}
+}
+
+/**
+ * Cleans up the radar grid.
+ */
+RadarGrid::~RadarGrid()
+{
+}
+
+/**
+ * Adds a radar to every cell with a point in its range.
+ * @param radar Radar to add.
+ * @param position Where the radar is.
+ * @param range Radar range in nautical miles.
+ */
+void RadarGrid::addRadar(const Radar &radar, const Target *position, int range)
+{
+	const double cellSize = CellSize * M_PI / 180;
+	// padded a little so rounding can only add radars to a cell, never leave them out
+	const double pad = 1e-6;
+	double reach = range * (1 / 60.0) * (M_PI / 180) + pad;
+	double lon = position->getLongitude(), lat = position->getLatitude();
+	for (int y = 0; y < CellsLat; ++y)
+	{
+		double latMin = y * cellSize - M_PI_2, latCenter = latMin + cellSize / 2;
+		// furthest a point in the cell can be from its center
+		double cellRadius = std::max(
+			acos(std::min(1.0, cos(latCenter) * cos(latMin) * cos(cellSize / 2) + sin(latCenter) * sin(latMin))),
+			acos(std::min(1.0, cos(latCenter) * cos(latMin + cellSize) * cos(cellSize / 2) + sin(latCenter) * sin(latMin + cellSize))));
+		double minCos = cos(std::min(reach + cellRadius, M_PI));
+		for (int x = 0; x < CellsLon; ++x)
+		{
+			double lonCenter = (x + 0.5) * cellSize;
+			if (cos(lat) * cos(latCenter) * cos(lonCenter - lon) + sin(lat) * sin(latCenter) >= minCos)
+			{
+				_cells[y * CellsLon + x].push_back(radar);
+			}
+		}
+	}
+	_cells.back().push_back(radar);
+}
+
+/**
+ * Returns the radars that might reach a target, in the order they
+ * would be checked. Any other radar is sure to be out of range.
+ * @param target Target to detect.
+ * @return List of radars.
+ */
+const std::vector<RadarGrid::Radar> &RadarGrid::getRadars(const Target *target) const
+{
+	const double cellSize = CellSize * M_PI / 180;
+	double lon = fmod(target->getLongitude(), 2 * M_PI), lat = target->getLatitude();
+	if (lon < 0)
+	{
+		lon += 2 * M_PI;
+	}
+	if (!(lon >= 0 && lon <= 2 * M_PI && lat >= -M_PI_2 && lat <= M_PI_2))
+	{
+		return _cells.back();
+	}
+	int x = std::min((int)(lon / cellSize), CellsLon - 1);
+	int y = std::min((int)((lat + M_PI_2) / cellSize), CellsLat - 1);
+	return _cells[y * CellsLon + x];
+}
+
+}
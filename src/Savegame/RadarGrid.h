@@ -0,0 +1,57 @@
+#pragma once
+/*
+ * Copyright 2010-2016 OpenXcom Developers.
+ *
+ * This file is part of OpenXcom.
+ *
+ * OpenXcom is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenXcom is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <vector>
+
+namespace OpenXcom
+{
+
+class Base;
+class Craft;
+class Target;
+
+/**
+ * Sorts the radars of every base and craft into a grid over the
+ * globe, so each UFO is only checked against the radars that can
+ * reach it. Radars are kept in the order they would be checked
+ * going through each base followed by its craft.
+ */
+class RadarGrid
+{
+public:
+	/// A base radar, or a craft radar if craft is set.
+	struct Radar
+	{
+		Base *base;
+		Craft *craft;
+	};
+private:
+	std::vector< std::vector<Radar> > _cells;
+	/// Adds a radar to every cell it can reach.
+	void addRadar(const Radar &radar, const Target *position, int range);
+public:
+	/// Sorts the radars of a list of bases into cells.
+	RadarGrid(const std::vector<Base*> &bases);
+	/// Cleans up the grid.
+	~RadarGrid();
+	/// Gets the radars that might reach a target.
+	const std::vector<Radar> &getRadars(const Target *target) const;
+};
+
+}
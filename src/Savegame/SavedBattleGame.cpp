@@ -18,6 +18,7 @@
  */
 #include <assert.h>
 #include <vector>
+#include <algorithm>
 #include "BattleItem.h"
 #include "SavedBattleGame.h"
 #include "SavedGame.h"
@@ -26,6 +27,7 @@
 #include "../Mod/MapDataSet.h"
 #include "../Mod/MCDPatch.h"
 #include "../Battlescape/Pathfinding.h"
+#include "../Battlescape/PlanningPool.h"
 #include "../Battlescape/TileEngine.h"
 #include "../Battlescape/BattlescapeState.h"
 #include "../Battlescape/BattlescapeGame.h"
@@ -38,6 +40,7 @@
 #include "../Engine/RNG.h"
 #include "../Engine/Options.h"
 #include "../Engine/Logger.h"
+#include "../Engine/Exception.h"
 #include "SerializationHelper.h"
 
 namespace OpenXcom
@@ -46,9 +49,9 @@ namespace OpenXcom
 /**
  * Initializes a brand new battlescape saved game.
  */
-SavedBattleGame::SavedBattleGame() : _battleState(0), _mapsize_x(0), _mapsize_y(0), _mapsize_z(0), _selectedUnit(0), _lastSelectedUnit(0), _pathfinding(0), _tileEngine(0), _globalShade(0),
+SavedBattleGame::SavedBattleGame() : _battleState(0), _mapsize_x(0), _mapsize_y(0), _mapsize_z(0), _selectedUnit(0), _lastSelectedUnit(0), _pathfinding(0), _planningPool(0), _tileEngine(0), _globalShade(0),
 	_side(FACTION_PLAYER), _turn(1), _debugMode(false), _aborted(false), _itemId(0), _objectiveType(-1), _objectivesDestroyed(0), _objectivesNeeded(0), _unitsFalling(false), _cheating(false),
-	_tuReserved(BA_NONE), _kneelReserved(false), _depth(0), _ambience(-1), _ambientVolume(0.5), _turnLimit(0), _cheatTurn(20), _chronoTrigger(FORCE_LOSE), _beforeGame(true)
+	_tuReserved(BA_NONE), _kneelReserved(false), _depth(0), _ambience(-1), _ambientVolume(0.5), _turnLimit(0), _cheatTurn(20), _chronoTrigger(FORCE_LOSE), _beforeGame(true), _terrainVersion(0), _unitsVersion(0), _fireVersion(0)
 {
 	_tileSearch.resize(11*11);
 	for (int i = 0; i < 121; ++i)
@@ -104,6 +107,7 @@ SavedBattleGame::~SavedBattleGame()
 		delete *i;
 	}
 
+	delete _planningPool;
 	delete _pathfinding;
 	delete _tileEngine;
 }
@@ -113,8 +117,9 @@ SavedBattleGame::~SavedBattleGame()
  * @param node YAML node.
  * @param mod for the saved game.
  * @param savedGame Pointer to saved game.
+ * @param tiles Binary tile data kept outside the node, if any.
  */
-void SavedBattleGame::load(const YAML::Node &node, Mod *mod, SavedGame* savedGame)
+void SavedBattleGame::load(const YAML::Node &node, Mod *mod, SavedGame* savedGame, const std::string *tiles)
 {
 	int mapsize_x = node["width"].as<int>(_mapsize_x);
 	int mapsize_y = node["length"].as<int>(_mapsize_y);
@@ -158,10 +163,18 @@ void SavedBattleGame::load(const YAML::Node &node, Mod *mod, SavedGame* savedGam
 		serKey._mapDataSetID = node["tileSetIDSize"].as<Uint8>(serKey._mapDataSetID);
 		serKey.boolFields = node["tileBoolFieldsSize"].as<Uint8>(1); // boolean flags used to be stored in an unmentioned byte (Uint8) :|
 
-		// load binary tile data!
-		YAML::Binary binTiles = node["binTiles"].as<YAML::Binary>();
-
-		Uint8 *r = (Uint8*)binTiles.data();
+		// load binary tile data! binary saves keep it outside the node so it isn't base64'd
+		YAML::Binary binTiles;
+		if (tiles == 0)
+		{
+			binTiles = node["binTiles"].as<YAML::Binary>();
+		}
+		Uint8 *r = tiles ? (Uint8*)tiles->data() : (Uint8*)binTiles.data();
+		size_t dataSize = tiles ? tiles->size() : binTiles.size();
+		if (serKey.totalBytes <= serKey.index || totalTiles > dataSize / serKey.totalBytes)
+		{
+			throw Exception("Invalid battlescape tile data");
+		}
 		Uint8 *dataEnd = r + totalTiles * serKey.totalBytes;
 
 		while (r < dataEnd)
@@ -377,9 +390,10 @@ void SavedBattleGame::loadMapResources(Mod *mod)
 
 /**
  * Saves the saved battle game to a YAML file.
+ * @param tiles If set, gets the binary tile data instead of the node.
  * @return YAML node.
  */
-YAML::Node SavedBattleGame::save() const
+YAML::Node SavedBattleGame::save(std::string *tiles) const
 {
 	YAML::Node node;
 	if (_objectivesNeeded)
@@ -434,7 +448,14 @@ YAML::Node SavedBattleGame::save() const
 		}
 	}
 	node["totalTiles"] = tileDataSize / Tile::serializationKey.totalBytes; // not strictly necessary, just convenient
-	node["binTiles"] = YAML::Binary(tileData, tileDataSize);
+	if (tiles != 0)
+	{
+		tiles->assign((const char*)tileData, tileDataSize);
+	}
+	else
+	{
+		node["binTiles"] = YAML::Binary(tileData, tileDataSize);
+	}
 	free(tileData);
 #endif
 	for (std::vector<Node*>::const_iterator i = _nodes.begin(); i != _nodes.end(); ++i)
@@ -528,8 +549,10 @@ void SavedBattleGame::initMap(int mapsize_x, int mapsize_y, int mapsize_z)
  */
 void SavedBattleGame::initUtilities(Mod *mod)
 {
+	delete _planningPool;
 	delete _pathfinding;
 	delete _tileEngine;
+	_planningPool = 0;
 	_pathfinding = new Pathfinding(this);
 	_tileEngine = new TileEngine(this, mod->getVoxelData());
 }
@@ -786,6 +809,20 @@ Pathfinding *SavedBattleGame::getPathfinding() const
 	return _pathfinding;
 }
 
+/**
+ * Gets the worker pool the AI uses to evaluate candidate moves,
+ * starting its threads the first time it is needed.
+ * @return Pointer to the planning pool.
+ */
+PlanningPool *SavedBattleGame::getPlanningPool()
+{
+	if (!_planningPool)
+	{
+		_planningPool = new PlanningPool(this, std::max(0, Options::battleAIThreads));
+	}
+	return _planningPool;
+}
+
 /**
  * Gets the terrain modifier object.
  * @return Pointer to the terrain modifier object.
@@ -992,6 +1029,7 @@ void SavedBattleGame::resetUnitTiles()
 			(*i)->setVisible(true);
 		}
 	}
+	unitsChanged();
 	_beforeGame = false;
 }
 
@@ -1290,6 +1328,8 @@ void SavedBattleGame::prepareNewTurn()
 	std::vector<Tile*> tilesOnFire;
 	std::vector<Tile*> tilesOnSmoke;
 
+	fireChanged();
+
 	// prepare a list of tiles on fire
 	for (int i = 0; i < _mapsize_x * _mapsize_y * _mapsize_z; ++i)
 	{
@@ -1342,6 +1382,7 @@ void SavedBattleGame::prepareNewTurn()
 						{
 							addDestroyedObjective();
 						}
+						terrainChanged(*i);
 					}
 				}
 				else if ((*i)->getMapData(O_FLOOR))
@@ -1352,6 +1393,7 @@ void SavedBattleGame::prepareNewTurn()
 						{
 							addDestroyedObjective();
 						}
+						terrainChanged(*i);
 					}
 				}
 				getTileEngine()->applyGravity(*i);
@@ -1468,6 +1510,7 @@ void SavedBattleGame::reviveUnconsciousUnits()
 					// recover from unconscious
 					(*i)->turn(false); // makes the unit stand up again
 					(*i)->kneel(false);
+					unitsChanged();
 					(*i)->setCache(0);
 					getTileEngine()->calculateFOV((*i));
 					getTileEngine()->calculateUnitLighting();
@@ -1554,6 +1597,7 @@ bool SavedBattleGame::setUnitPosition(BattleUnit *bu, Position position, bool te
 			getTile(position + Position(x,y,0) + zOffset)->setUnit(bu, getTile(position + Position(x,y,-1) + zOffset));
 		}
 	}
+	unitsChanged();
 
 	return true;
 }
@@ -1764,6 +1808,80 @@ void SavedBattleGame::resetTiles()
 		_tiles[i]->setDiscovered(false, 1);
 		_tiles[i]->setDiscovered(false, 2);
 	}
+	++_terrainVersion;
+}
+
+/**
+ * Notes that the terrain of a tile has changed (destroyed objects,
+ * opened or closed doors), so anything cached from the map layout
+ * knows it has to be recalculated.
+ * @param tile The tile that changed.
+ */
+void SavedBattleGame::terrainChanged(Tile *tile)
+{
+	++_terrainVersion;
+	if (_pathfinding)
+	{
+		_pathfinding->terrainChanged(tile->getPosition());
+	}
+	if (_planningPool)
+	{
+		_planningPool->terrainChanged(tile->getPosition());
+	}
+	if (_tileEngine)
+	{
+		_tileEngine->terrainChanged(tile);
+	}
+}
+
+/**
+ * Gets the version number of the map terrain, which goes up
+ * every time the terrain is changed.
+ * @return The terrain version.
+ */
+int SavedBattleGame::getTerrainVersion() const
+{
+	return _terrainVersion;
+}
+
+/**
+ * Notes that units may have moved, died, changed sides or been
+ * seen, so anything cached from the units' positions knows it
+ * has to be recalculated.
+ */
+void SavedBattleGame::unitsChanged()
+{
+	++_unitsVersion;
+}
+
+/**
+ * Gets the version number of the units' positions and states,
+ * which goes up every time they may have changed.
+ * @return The units version.
+ */
+int SavedBattleGame::getUnitsVersion() const
+{
+	return _unitsVersion;
+}
+
+/**
+ * Notes that tiles may have caught fire or stopped burning,
+ * so anything cached from the fires knows it has to be
+ * recalculated.
+ */
+void SavedBattleGame::fireChanged()
+{
+	++_fireVersion;
+}
+
+/**
+ * Gets the version number of the fires on the map,
+ * which goes up every time they may have changed.
+ * @return The fire version.
+ */
+int SavedBattleGame::getFireVersion() const
+{
+	return _fireVersion;
 }
 
 /**
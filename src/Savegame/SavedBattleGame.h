@@ -33,6 +33,7 @@ class Node;
 class BattlescapeState;
 class Position;
 class Pathfinding;
+class PlanningPool;
 class TileEngine;
 class BattleItem;
 class Mod;
@@ -55,6 +56,7 @@ private:
 	std::vector<BattleUnit*> _units;
 	std::vector<BattleItem*> _items, _deleted;
 	Pathfinding *_pathfinding;
+	PlanningPool *_planningPool;
 	TileEngine *_tileEngine;
 	std::string _missionType;
 	int _globalShade;
@@ -78,6 +80,7 @@ private:
 	int _turnLimit, _cheatTurn;
 	ChronoTrigger _chronoTrigger;
 	bool _beforeGame;
+	int _terrainVersion, _unitsVersion, _fireVersion;
 	/// Selects a soldier.
 	BattleUnit *selectPlayerUnit(int dir, bool checkReselect = false, bool setReselect = false, bool checkInventory = false);
 public:
@@ -86,9 +89,9 @@ public:
 	/// Cleans up the saved game.
 	~SavedBattleGame();
 	/// Loads a saved battle game from YAML.
-	void load(const YAML::Node& node, Mod *mod, SavedGame* savedGame);
+	void load(const YAML::Node& node, Mod *mod, SavedGame* savedGame, const std::string *tiles = 0);
 	/// Saves a saved battle game to YAML.
-	YAML::Node save() const;
+	YAML::Node save(std::string *tiles = 0) const;
 	/// Sets the dimensions of the map and initializes it.
 	void initMap(int mapsize_x, int mapsize_y, int mapsize_z);
 	/// Initialises the pathfinding and tileengine.
@@ -162,6 +165,8 @@ public:
 	BattleUnit *selectUnit(Position pos);
 	/// Gets the pathfinding object.
 	Pathfinding *getPathfinding() const;
+	/// Gets the worker pool for AI planning.
+	PlanningPool *getPlanningPool();
 	/// Gets a pointer to the tileengine.
 	TileEngine *getTileEngine() const;
 	/// Gets the playing side.
@@ -230,6 +235,18 @@ public:
 	void resetTurnCounter();
 	/// Resets the visibility of all tiles on the map.
 	void resetTiles();
+	/// Notes that the terrain of a tile has changed.
+	void terrainChanged(Tile *tile);
+	/// Gets the version number of the map terrain.
+	int getTerrainVersion() const;
+	/// Notes that units may have moved, died, changed sides or been seen.
+	void unitsChanged();
+	/// Gets the version number of the units' positions and states.
+	int getUnitsVersion() const;
+	/// Notes that tiles may have caught fire or stopped burning.
+	void fireChanged();
+	/// Gets the version number of the fires on the map.
+	int getFireVersion() const;
 	/// get an 11x11 grid of positions (-10 to +10) to check.
 	const std::vector<Position> &getTileSearch() const;
 	/// check if the AI has engaged cheat mode.
@@ -21,6 +21,7 @@
 #include <sstream>
 #include <iomanip>
 #include <algorithm>
+#include <sys/stat.h>
 #include <yaml-cpp/yaml.h>
 #include "../version.h"
 #include "../Engine/Logger.h"
@@ -30,6 +31,9 @@
 #include "../Engine/Exception.h"
 #include "../Engine/Options.h"
 #include "../Engine/CrossPlatform.h"
+#include "../Engine/BinaryNode.h"
+#include "../lodepng.h"
+#include "../fmath.h"
 #include "SavedBattleGame.h"
 #include "SerializationHelper.h"
 #include "GameTime.h"
@@ -51,6 +55,7 @@
 #include "AlienStrategy.h"
 #include "AlienMission.h"
 #include "../Mod/RuleRegion.h"
+#include "../Mod/RuleCountry.h"
 #include "MissionStatistics.h"
 #include "SoldierDeath.h"
 
@@ -189,8 +194,208 @@ static bool _isCurrentGameType(const SaveInfo &saveInfo, const std::string &curM
 	return true;
 }
 
+/// File in the user folder keeping the brief info of every save.
+static const std::string SAVE_INDEX = "saves.idx";
+
+/**
+ * Gets a key that changes whenever a save file is rewritten.
+ * @param path Full path to the file.
+ * @return Modified date and size of the file.
+ */
+static std::string _getFileStamp(const std::string &path)
+{
+	std::ostringstream stamp;
+	struct stat info;
+	if (stat(path.c_str(), &info) == 0)
+	{
+		stamp << info.st_mtime << " " << info.st_size;
+	}
+	return stamp.str();
+}
+
+/// Identifies saves written in the binary format.
+static const char BINARY_SAVE_MAGIC[4] = { 'O', 'X', 'S', 'G' };
+/// Layout version of binary saves, bumped whenever the layout changes.
+static const Uint32 BINARY_SAVE_VERSION = 2;
+/// Sections smaller than this are stored without compression.
+static const size_t BINARY_SAVE_MIN_COMPRESS = 256;
+/// Section names are never longer than this.
+static const Uint32 BINARY_SAVE_MAX_NAME = 256;
+/// Deflate can't shrink data more than this, so bigger sizes are corrupt.
+static const Uint32 BINARY_SAVE_MAX_RATIO = 1032;
+/// Section flag: the contents are compressed.
+static const char BINARY_SECTION_COMPRESSED = 1;
+/// Section flag: the contents are raw bytes instead of a node.
+static const char BINARY_SECTION_RAW = 2;
+
+/**
+ * Checks if a save file is in the binary format, and if so skips
+ * past its header.
+ * @param in Stream at the start of the save file.
+ * @param filename Save filename, for errors.
+ * @return Number of sections in the save, or 0 if it's a YAML save.
+ */
+static Uint32 _readBinaryHeader(std::istream &in, const std::string &filename)
+{
+	std::string header(12, 0);
+	if (!in.read(&header[0], header.size()) || header.compare(0, 4, BINARY_SAVE_MAGIC, 4) != 0)
+	{
+		in.clear();
+		in.seekg(0);
+		return 0;
+	}
+	size_t pos = 4;
+	Uint32 version, sections;
+	BinaryNode::readInt(header, pos, version);
+	BinaryNode::readInt(header, pos, sections);
+	if (version > BINARY_SAVE_VERSION)
+	{
+		throw Exception(filename + " was saved by a newer version");
+	}
+	return sections;
+}
+
+/**
+ * Writes a section of a binary save: its name and flags, then its
+ * contents, compressed unless they're tiny.
+ * @param out Stream to write to.
+ * @param name Section name.
+ * @param raw Section contents.
+ * @param flags Section flags.
+ */
+static void _writeBinarySection(std::ostream &out, const std::string &name, const std::string &raw, char flags)
+{
+	std::vector<unsigned char> packed;
+	bool compressed = raw.size() >= BINARY_SAVE_MIN_COMPRESS &&
+		lodepng::compress(packed, (const unsigned char*)raw.data(), raw.size()) == 0 && packed.size() < raw.size();
+
+	std::string header;
+	BinaryNode::writeString(header, name);
+	header += compressed ? (char)(flags | BINARY_SECTION_COMPRESSED) : flags;
+	BinaryNode::writeInt(header, raw.size());
+	if (compressed)
+	{
+		BinaryNode::writeInt(header, packed.size());
+		out.write(header.data(), header.size());
+		out.write((const char*)&packed[0], packed.size());
+	}
+	else
+	{
+		BinaryNode::writeInt(header, raw.size());
+		out.write(header.data(), header.size());
+		out.write(raw.data(), raw.size());
+	}
+}
+
+/**
+ * Writes out the sections gathered so far for a binary save and lets
+ * go of them, so the whole game never has to be held in memory at once.
+ * YAML saves are only emitted whole, so they just keep gathering.
+ * @param out Stream to write to, or 0 for a YAML save.
+ * @param node Sections gathered so far.
+ * @param sections Number of sections written, updated.
+ */
+static void _flushBinarySections(std::ostream *out, YAML::Node &node, Uint32 &sections)
+{
+	if (out == 0)
+	{
+		return;
+	}
+	for (YAML::const_iterator i = node.begin(); i != node.end(); ++i)
+	{
+		std::string raw;
+		BinaryNode::write(raw, i->second);
+		_writeBinarySection(*out, i->first.as<std::string>(), raw, 0);
+		sections++;
+	}
+	node.reset();
+}
+
+/**
+ * Reads the next section of a binary save.
+ * @param in Stream to read from.
+ * @param filename Save filename, for errors.
+ * @param name Section name read.
+ * @param data Section contents read.
+ * @return Section flags.
+ */
+static char _readBinarySection(std::istream &in, const std::string &filename, std::string &name, std::string &data)
+{
+	// the stream is only trusted as far as its actual length
+	std::streampos start = in.tellg();
+	in.seekg(0, std::ios::end);
+	std::streamoff left = in.tellg() - start;
+	in.seekg(start);
+
+	data.assign(4, 0);
+	size_t pos = 0;
+	Uint32 size, rawSize;
+	if (!in.read(&data[0], 4) || !BinaryNode::readInt(data, pos, size) || size > BINARY_SAVE_MAX_NAME)
+	{
+		throw Exception("Failed to load " + filename);
+	}
+	data.resize(4 + size + 9);
+	if (!in.read(&data[4], size + 9))
+	{
+		throw Exception("Failed to load " + filename);
+	}
+	left -= data.size();
+	pos = 0;
+	if (!BinaryNode::readString(data, pos, name))
+	{
+		throw Exception("Failed to load " + filename);
+	}
+	char flags = data[pos++];
+	bool compressed = (flags & BINARY_SECTION_COMPRESSED) != 0;
+	if (!BinaryNode::readInt(data, pos, rawSize) || !BinaryNode::readInt(data, pos, size) ||
+		(std::streamoff)size > left || (!compressed && rawSize != size) ||
+		(compressed && rawSize / BINARY_SAVE_MAX_RATIO > size))
+	{
+		throw Exception("Failed to load " + filename);
+	}
+
+	data.resize(size);
+	if (size != 0 && !in.read(&data[0], size))
+	{
+		throw Exception("Failed to load " + filename);
+	}
+	if (compressed)
+	{
+		// never inflate past the size the section claims to have
+		LodePNGDecompressSettings settings;
+		lodepng_decompress_settings_init(&settings);
+		settings.max_output_size = rawSize;
+		std::vector<unsigned char> raw;
+		if (lodepng::decompress(raw, (const unsigned char*)data.data(), data.size(), settings) != 0 || raw.size() != rawSize)
+		{
+			throw Exception("Failed to load " + filename);
+		}
+		data.assign(raw.begin(), raw.end());
+	}
+	return flags;
+}
+
+/**
+ * Reads the next section of a binary save as a node.
+ * @param in Stream to read from.
+ * @param filename Save filename, for errors.
+ * @param name Section name read.
+ * @param node Section contents read.
+ */
+static void _readBinarySection(std::istream &in, const std::string &filename, std::string &name, YAML::Node &node)
+{
+	std::string data;
+	size_t pos = 0;
+	if ((_readBinarySection(in, filename, name, data) & BINARY_SECTION_RAW) != 0 || !BinaryNode::read(data, pos, node))
+	{
+		throw Exception("Failed to load " + filename);
+	}
+}
+
 /**
  * Gets all the info of the saves found in the user folder.
+ * Only the brief info at the start of each save is read, and it's
+ * kept in an index file so unchanged saves don't need reading again.
  * @param lang Loaded language.
  * @param autoquick Include autosaves and quicksaves.
  * @return List of saves info.
@@ -206,11 +411,42 @@ std::vector<SaveInfo> SavedGame::getList(Language *lang, bool autoquick)
 		std::vector<std::string> asaves = CrossPlatform::getFolderContents(Options::getMasterUserFolder(), "asav");
 		saves.insert(saves.begin(), asaves.begin(), asaves.end());
 	}
+
+	std::string indexFile = Options::getMasterUserFolder() + SAVE_INDEX;
+	YAML::Node index, newIndex;
+	const YAML::Node &oldIndex = index, &curIndex = newIndex;
+	bool indexChanged = false;
+	try
+	{
+		if (CrossPlatform::fileExists(indexFile))
+		{
+			index = YAML::LoadFile(indexFile);
+		}
+	}
+	catch (YAML::Exception &e)
+	{
+		Log(LOG_WARNING) << indexFile << ": " << e.what();
+	}
+	newIndex = YAML::Node(YAML::NodeType::Map);
+
 	for (std::vector<std::string>::iterator i = saves.begin(); i != saves.end(); ++i)
 	{
 		try
 		{
-			SaveInfo saveInfo = getSaveInfo(*i, lang);
+			std::string stamp = _getFileStamp(Options::getMasterUserFolder() + *i);
+			YAML::Node doc;
+			if (oldIndex.IsMap() && oldIndex[*i] && oldIndex[*i]["stamp"].as<std::string>("") == stamp)
+			{
+				doc = oldIndex[*i]["header"];
+			}
+			else
+			{
+				doc = loadHeader(*i);
+				indexChanged = true;
+			}
+			newIndex[*i]["stamp"] = stamp;
+			newIndex[*i]["header"] = doc;
+			SaveInfo saveInfo = getSaveInfo(*i, doc, lang);
 			if (!_isCurrentGameType(saveInfo, curMaster))
 			{
 				continue;
@@ -229,18 +465,94 @@ std::vector<SaveInfo> SavedGame::getList(Language *lang, bool autoquick)
 		}
 	}
 
+	// keep saves that weren't listed this time, drop the ones that are gone
+	if (index.IsMap())
+	{
+		for (YAML::const_iterator i = index.begin(); i != index.end(); ++i)
+		{
+			std::string file = i->first.as<std::string>();
+			if (!curIndex[file] && CrossPlatform::fileExists(Options::getMasterUserFolder() + file))
+			{
+				newIndex[file] = i->second;
+			}
+		}
+	}
+	if (indexChanged || !index.IsMap() || index.size() != newIndex.size())
+	{
+		std::ofstream out(indexFile.c_str());
+		YAML::Emitter emitter;
+		emitter << newIndex;
+		out << emitter.c_str() << std::endl;
+		if (!out)
+		{
+			Log(LOG_WARNING) << "Failed to save " << indexFile;
+		}
+	}
+
 	return info;
 }
 
 /**
- * Gets the info of a specific save file.
+ * Reads the brief info at the start of a save file, which is the
+ * first YAML document or binary section in it, without going through
+ * the rest of the game data.
+ * @param file Save filename.
+ * @return Brief info.
+ */
+YAML::Node SavedGame::loadHeader(const std::string &file)
+{
+	std::string fullname = Options::getMasterUserFolder() + file;
+	std::ifstream in(fullname.c_str(), std::ios::in | std::ios::binary);
+	if (!in)
+	{
+		throw Exception("Failed to load " + file);
+	}
+	if (_readBinaryHeader(in, file) != 0)
+	{
+		std::string name;
+		YAML::Node brief;
+		_readBinarySection(in, file, name, brief);
+		return brief;
+	}
+	std::string header, line;
+	bool started = false;
+	while (std::getline(in, line))
+	{
+		if (!line.empty() && line[line.size() - 1] == '\r')
+		{
+			line.erase(line.size() - 1);
+		}
+		if (line == "---" || line == "..." || line.compare(0, 4, "--- ") == 0)
+		{
+			if (started)
+			{
+				break;
+			}
+			if (line != "---")
+			{
+				header += line.substr(3) + "\n";
+				started = true;
+			}
+			continue;
+		}
+		if (!line.empty() && line[0] != '#')
+		{
+			started = true;
+		}
+		header += line + "\n";
+	}
+	return YAML::Load(header);
+}
+
+/**
+ * Gets the info of a specific save from its brief info.
  * @param file Save filename.
+ * @param doc Brief info at the start of the save.
  * @param lang Loaded language.
  */
-SaveInfo SavedGame::getSaveInfo(const std::string &file, Language *lang)
+SaveInfo SavedGame::getSaveInfo(const std::string &file, const YAML::Node &doc, Language *lang)
 {
 	std::string fullname = Options::getMasterUserFolder() + file;
-	YAML::Node doc = YAML::LoadFile(fullname);
 	SaveInfo save;
 
 	save.fileName = file;
@@ -303,16 +615,62 @@ SaveInfo SavedGame::getSaveInfo(const std::string &file, Language *lang)
 }
 
 /**
- * Loads a saved game's contents from a YAML file.
+ * Loads a saved game's contents from a YAML or binary file.
  * @note Assumes the saved game is blank.
- * @param filename YAML filename.
+ * @param filename Save filename.
  * @param mod Mod for the saved game.
  */
 void SavedGame::load(const std::string &filename, Mod *mod)
 {
 	std::string s = Options::getMasterUserFolder() + filename;
-	std::vector<YAML::Node> file = YAML::LoadAllFromFile(s);
-	if (file.empty())
+	std::vector<YAML::Node> file;
+	std::string battleTiles;
+	bool hasBattleTiles = false;
+	std::ifstream in(s.c_str(), std::ios::in | std::ios::binary);
+	if (!in)
+	{
+		throw Exception("Failed to load " + filename);
+	}
+	if (Uint32 sections = _readBinaryHeader(in, filename))
+	{
+		// the brief info comes first, then a section for each part of the game data,
+		// with the battlescape tiles kept as raw bytes
+		file.resize(2);
+		file[1] = YAML::Node(YAML::NodeType::Map);
+		for (Uint32 i = 0; i < sections; ++i)
+		{
+			std::string name, data;
+			YAML::Node section;
+			size_t pos = 0;
+			if ((_readBinarySection(in, filename, name, data) & BINARY_SECTION_RAW) != 0)
+			{
+				if (i == 0 || name != "battleTiles")
+				{
+					throw Exception("Failed to load " + filename);
+				}
+				battleTiles.swap(data);
+				hasBattleTiles = true;
+				continue;
+			}
+			if (!BinaryNode::read(data, pos, section))
+			{
+				throw Exception("Failed to load " + filename);
+			}
+			if (i == 0)
+			{
+				file[0] = section;
+			}
+			else
+			{
+				file[1][name] = section;
+			}
+		}
+	}
+	else
+	{
+		file = YAML::LoadAll(in);
+	}
+	if (file.size() < 2)
 	{
 		throw Exception(filename + " is not a vaild save file");
 	}
@@ -538,25 +896,24 @@ void SavedGame::load(const std::string &filename, Mod *mod)
 	if (const YAML::Node &battle = doc["battleGame"])
 	{
 		_battleGame = new SavedBattleGame();
-		_battleGame->load(battle, mod, this);
+		_battleGame->load(battle, mod, this, hasBattleTiles ? &battleTiles : 0);
 	}
 }
 
 /**
- * Saves a saved game's contents to a YAML file.
- * @param filename YAML filename.
+ * Saves a saved game's contents to a YAML file, or a binary
+ * file if the player prefers those.
+ * @param filename Save filename.
  */
 void SavedGame::save(const std::string &filename) const
 {
 	std::string s = Options::getMasterUserFolder() + filename;
-	std::ofstream sav(s.c_str());
+	std::ofstream sav(s.c_str(), Options::binarySaves ? std::ios::out | std::ios::binary : std::ios::out);
 	if (!sav)
 	{
 		throw Exception("Failed to save " + filename);
 	}
 
-	YAML::Emitter out;
-
 	// Saves the brief game info used in the saves list
 	YAML::Node brief;
 	brief["name"] = Language::wstrToUtf8(_name);
@@ -596,9 +953,24 @@ void SavedGame::save(const std::string &filename) const
 	brief["mods"] = activeMods;
 	if (_ironman)
 		brief["ironman"] = _ironman;
-	out << brief;
+
+	// Binary saves write each part of the game data as soon as it's built,
+	// the section count in the header gets filled in at the end
+	std::ostream *bin = Options::binarySaves ? &sav : 0;
+	Uint32 sections = 0;
+	if (bin != 0)
+	{
+		std::string header(BINARY_SAVE_MAGIC, sizeof(BINARY_SAVE_MAGIC));
+		BinaryNode::writeInt(header, BINARY_SAVE_VERSION);
+		BinaryNode::writeInt(header, 0);
+		sav.write(header.data(), header.size());
+		std::string raw;
+		BinaryNode::write(raw, brief);
+		_writeBinarySection(sav, "brief", raw, 0);
+		sections++;
+	}
+
 	// Saves the full game data to the save
-	out << YAML::BeginDoc;
 	YAML::Node node;
 	node["difficulty"] = (int)_difficulty;
 	node["end"] = (int)_end;
@@ -617,6 +989,7 @@ void SavedGame::save(const std::string &filename) const
 	node["globeLat"] = serializeDouble(_globeLat);
 	node["globeZoom"] = _globeZoom;
 	node["ids"] = _ids;
+	_flushBinarySections(bin, node, sections);
 	for (std::vector<Country*>::const_iterator i = _countries.begin(); i != _countries.end(); ++i)
 	{
 		node["countries"].push_back((*i)->save());
@@ -629,6 +1002,7 @@ void SavedGame::save(const std::string &filename) const
 	{
 		node["bases"].push_back((*i)->save());
 	}
+	_flushBinarySections(bin, node, sections);
 	for (std::vector<Waypoint*>::const_iterator i = _waypoints.begin(); i != _waypoints.end(); ++i)
 	{
 		node["waypoints"].push_back((*i)->save());
@@ -652,6 +1026,7 @@ void SavedGame::save(const std::string &filename) const
 	{
 		node["ufos"].push_back((*i)->save(getMonthsPassed() == -1));
 	}
+	_flushBinarySections(bin, node, sections);
 	for (std::vector<const RuleResearch *>::const_iterator i = _discovered.begin(); i != _discovered.end(); ++i)
 	{
 		node["discovered"].push_back((*i)->getName());
@@ -672,12 +1047,39 @@ void SavedGame::save(const std::string &filename) const
 			node["missionStatistics"].push_back((*i)->save());
 		}
 	}
+	_flushBinarySections(bin, node, sections);
 	if (_battleGame != 0)
 	{
-		node["battleGame"] = _battleGame->save();
+		if (bin != 0)
+		{
+			// the tiles go in a raw section of their own instead of a base64 node
+			std::string tiles;
+			node["battleGame"] = _battleGame->save(&tiles);
+			_flushBinarySections(bin, node, sections);
+			_writeBinarySection(sav, "battleTiles", tiles, BINARY_SECTION_RAW);
+			sections++;
+		}
+		else
+		{
+			node["battleGame"] = _battleGame->save();
+		}
+	}
+
+	if (bin != 0)
+	{
+		std::string count;
+		BinaryNode::writeInt(count, sections);
+		sav.seekp(sizeof(BINARY_SAVE_MAGIC) + 4); // past the magic and version
+		sav.write(count.data(), count.size());
+	}
+	else
+	{
+		YAML::Emitter out;
+		out << brief;
+		out << YAML::BeginDoc;
+		out << node;
+		sav << out.c_str();
 	}
-	out << node;
-	sav << out.c_str();
 	sav.close();
 }
 
@@ -1758,19 +2160,92 @@ void SavedGame::setWarned(bool warned)
 	_warned = warned;
 }
 
-/** @brief Check if a point is contained in a region.
- * This function object checks if a point is contained inside a region.
+/// Size of the cells in the region and country lookup grids, in degrees.
+static const int AREA_CELL_SIZE = 5;
+static const int AREA_CELLS_LON = 360 / AREA_CELL_SIZE, AREA_CELLS_LAT = 180 / AREA_CELL_SIZE;
+
+static bool _insideArea(const Region *region, double lon, double lat)
+{
+	return region->getRules()->insideRegion(lon, lat);
+}
+
+static bool _insideArea(const Country *country, double lon, double lat)
+{
+	return country->getRules()->insideCountry(lon, lat);
+}
+
+/**
+ * Finds the first region or country containing a location. A grid of
+ * the ones overlapping each cell of the globe is kept so only those
+ * need checking, and it's rebuilt whenever the list changes.
+ * @param areas List of regions or countries.
+ * @param indexed List the grid was built from.
+ * @param cells Grid of areas overlapping each cell, in list order.
+ * @param lon The longitude.
+ * @param lat The latitude.
+ * @return Pointer to the area, or 0.
  */
-class ContainsPoint: public std::unary_function<const Region *, bool>
+template <class T>
+static T *_locateArea(const std::vector<T*> &areas, std::vector<T*> &indexed, std::vector< std::vector<T*> > &cells, double lon, double lat)
 {
-public:
-	/// Remember the coordinates.
-	ContainsPoint(double lon, double lat) : _lon(lon), _lat(lat) { /* Empty by design. */ }
-	/// Check is the region contains the stored point.
-	bool operator()(const Region *region) const { return region->getRules()->insideRegion(_lon, _lat); }
-private:
-	double _lon, _lat;
-};
+	const double cellSize = AREA_CELL_SIZE * M_PI / 180;
+	if (!(lon >= 0 && lon < 2 * M_PI && lat >= -M_PI_2 && lat < M_PI_2))
+	{
+		// off the grid, check them all
+		for (typename std::vector<T*>::const_iterator i = areas.begin(); i != areas.end(); ++i)
+		{
+			if (_insideArea(*i, lon, lat))
+			{
+				return *i;
+			}
+		}
+		return 0;
+	}
+	if (indexed != areas)
+	{
+		indexed = areas;
+		cells.assign(AREA_CELLS_LON * AREA_CELLS_LAT, std::vector<T*>());
+		// padded a little so rounding can only add areas to a cell, never leave them out
+		const double pad = 1e-9;
+		for (typename std::vector<T*>::const_iterator i = areas.begin(); i != areas.end(); ++i)
+		{
+			const std::vector<double> &lonMin = (*i)->getRules()->getLonMin(), &lonMax = (*i)->getRules()->getLonMax();
+			const std::vector<double> &latMin = (*i)->getRules()->getLatMin(), &latMax = (*i)->getRules()->getLatMax();
+			for (int y = 0; y < AREA_CELLS_LAT; ++y)
+			{
+				double cellLatMin = y * cellSize - M_PI_2, cellLatMax = cellLatMin + cellSize;
+				for (int x = 0; x < AREA_CELLS_LON; ++x)
+				{
+					double cellLonMin = x * cellSize, cellLonMax = cellLonMin + cellSize;
+					for (size_t j = 0; j < lonMin.size(); ++j)
+					{
+						bool inLon;
+						if (lonMin[j] <= lonMax[j])
+							inLon = lonMin[j] <= cellLonMax + pad && cellLonMin <= lonMax[j] + pad;
+						else
+							inLon = lonMin[j] <= cellLonMax + pad || cellLonMin <= lonMax[j] + pad;
+						if (inLon && latMin[j] <= cellLatMax + pad && cellLatMin <= latMax[j] + pad)
+						{
+							cells[y * AREA_CELLS_LON + x].push_back(*i);
+							break;
+						}
+					}
+				}
+			}
+		}
+	}
+	int x = std::min((int)(lon / cellSize), AREA_CELLS_LON - 1);
+	int y = std::min((int)((lat + M_PI_2) / cellSize), AREA_CELLS_LAT - 1);
+	const std::vector<T*> &cell = cells[y * AREA_CELLS_LON + x];
+	for (typename std::vector<T*>::const_iterator i = cell.begin(); i != cell.end(); ++i)
+	{
+		if (_insideArea(*i, lon, lat))
+		{
+			return *i;
+		}
+	}
+	return 0;
+}
 
 /**
  * Find the region containing this location.
@@ -1780,12 +2255,7 @@ private:
  */
 Region *SavedGame::locateRegion(double lon, double lat) const
 {
-	std::vector<Region *>::const_iterator found = std::find_if (_regions.begin(), _regions.end(), ContainsPoint(lon, lat));
-	if (found != _regions.end())
-	{
-		return *found;
-	}
-	return 0;
+	return _locateArea(_regions, _indexedRegions, _regionCells, lon, lat);
 }
 
 /**
@@ -1798,6 +2268,27 @@ Region *SavedGame::locateRegion(const Target &target) const
 	return locateRegion(target.getLongitude(), target.getLatitude());
 }
 
+/**
+ * Find the country containing this location.
+ * @param lon The longtitude.
+ * @param lat The latitude.
+ * @return Pointer to the country, or 0.
+ */
+Country *SavedGame::locateCountry(double lon, double lat) const
+{
+	return _locateArea(_countries, _indexedCountries, _countryCells, lon, lat);
+}
+
+/**
+ * Find the country containing this target.
+ * @param target The target to locate.
+ * @return Pointer to the country, or 0.
+ */
+Country *SavedGame::locateCountry(const Target &target) const
+{
+	return locateCountry(target.getLongitude(), target.getLatitude());
+}
+
 /*
  * @return the month counter.
  */
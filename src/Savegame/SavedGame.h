@@ -130,9 +130,16 @@ private:
 	size_t _selectedBase;
 	std::string _lastselectedArmor; //contains the last selected armour
 	std::vector<MissionStatistics*> _missionStatistics;
+	mutable std::vector<Region*> _indexedRegions;
+	mutable std::vector<Country*> _indexedCountries;
+	mutable std::vector< std::vector<Region*> > _regionCells;
+	mutable std::vector< std::vector<Country*> > _countryCells;
 
 	void getDependableResearchBasic (std::vector<RuleResearch*> & dependables, const RuleResearch *research, const Mod *mod, Base *base) const;
-	static SaveInfo getSaveInfo(const std::string &file, Language *lang);
+	/// Reads the brief info at the start of a save file.
+	static YAML::Node loadHeader(const std::string &file);
+	/// Gets the info of a save from its brief info.
+	static SaveInfo getSaveInfo(const std::string &file, const YAML::Node &doc, Language *lang);
 public:
 	static const std::string AUTOSAVE_GEOSCAPE, AUTOSAVE_BATTLESCAPE, QUICKSAVE;
 	/// Creates a new saved game.
@@ -275,6 +282,10 @@ public:
 	Region *locateRegion(double lon, double lat) const;
 	/// Locate a region containing a Target.
 	Region *locateRegion(const Target &target) const;
+	/// Locate a country containing a position.
+	Country *locateCountry(double lon, double lat) const;
+	/// Locate a country containing a Target.
+	Country *locateCountry(const Target &target) const;
 	/// Return the month counter.
 	int getMonthsPassed() const;
 	/// Return the GraphRegionToggles.
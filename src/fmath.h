@@ -54,6 +54,12 @@ inline _Tx Sign(const _Tx& x)
 	return (_Tx(0) < x) - (x < _Tx(0));
 }
 
+/// Integer division rounding towards negative infinity (divisor must be positive).
+inline int FloorDiv(int x, int y)
+{
+	return x >= 0 ? x / y : -((-x + y - 1) / y);
+}
+
 template <class _Tx>
 inline _Tx Clamp(const _Tx& x, const _Tx& min, const _Tx& max)
 {
@@ -269,6 +269,10 @@ struct LodePNGDecompressSettings
                              const LodePNGDecompressSettings*);
 
   const void* custom_context; /*optional custom settings for custom functions*/
+
+  /*if not 0, decompression stops with an error as soon as the output would grow
+  past this many bytes, so corrupt data can't make it allocate without bound*/
+  size_t max_output_size;
 };
 
 extern const LodePNGDecompressSettings lodepng_default_decompress_settings;